@@ -14,6 +14,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Audio.h"
 #include "Command.h"
+#include "Dictionary.h"
 #include "DistanceMap.h"
 #include "Flotsam.h"
 #include "Government.h"
@@ -43,6 +44,34 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 using namespace std;
 
 namespace {
+	// Attributes that are looked up every frame.
+	const Dictionary::Key AFTERBURNER_ENERGY("afterburner energy");
+	const Dictionary::Key AFTERBURNER_FUEL("afterburner fuel");
+	const Dictionary::Key AFTERBURNER_HEAT("afterburner heat");
+	const Dictionary::Key AFTERBURNER_THRUST("afterburner thrust");
+	const Dictionary::Key ASTEROID_SCAN_POWER("asteroid scan power");
+	const Dictionary::Key ATMOSPHERE_SCAN("atmosphere scan");
+	const Dictionary::Key CARGO_SCAN_POWER("cargo scan power");
+	const Dictionary::Key CLOAK("cloak");
+	const Dictionary::Key CLOAKING_FUEL("cloaking fuel");
+	const Dictionary::Key DRAG("drag");
+	const Dictionary::Key ENERGY_CAPACITY("energy capacity");
+	const Dictionary::Key ENERGY_CONSUMPTION("energy consumption");
+	const Dictionary::Key ENERGY_GENERATION("energy generation");
+	const Dictionary::Key FUEL_CAPACITY("fuel capacity");
+	const Dictionary::Key FUEL_CONSUMPTION("fuel consumption");
+	const Dictionary::Key FUEL_GENERATION("fuel generation");
+	const Dictionary::Key HULL_REPAIR_RATE("hull repair rate");
+	const Dictionary::Key HYPERDRIVE("hyperdrive");
+	const Dictionary::Key JUMP_DRIVE("jump drive");
+	const Dictionary::Key JUMP_SPEED("jump speed");
+	const Dictionary::Key OUTFIT_SCAN_POWER("outfit scan power");
+	const Dictionary::Key RAMSCOOP("ramscoop");
+	const Dictionary::Key REVERSE_THRUST("reverse thrust");
+	const Dictionary::Key SCRAM_DRIVE("scram drive");
+	const Dictionary::Key SHIELD_GENERATION("shield generation");
+	const Dictionary::Key SOLAR_COLLECTION("solar collection");
+	
 	const Command &AutopilotCancelKeys()
 	{
 		static const Command keys(Command::LAND | Command::JUMP | Command::BOARD | Command::AFTERBURNER
@@ -54,7 +83,7 @@ namespace {
 	bool IsStranded(const Ship &ship)
 	{
 		return ship.GetSystem() && !ship.IsEnteringHyperspace() && !ship.GetSystem()->HasFuelFor(ship)
-			&& ship.JumpFuel() && ship.Attributes().Get("fuel capacity") && !ship.JumpsRemaining();
+			&& ship.JumpFuel() && ship.Attributes().Get(FUEL_CAPACITY) && !ship.JumpsRemaining();
 	}
 	
 	bool CanBoard(const Ship &ship, const Ship &target)
@@ -129,7 +158,7 @@ namespace {
 	bool ShouldRefuel(const Ship &ship, const DistanceMap &route, double fuelCapacity = 0.)
 	{
 		if(!fuelCapacity)
-			fuelCapacity = ship.Attributes().Get("fuel capacity");
+			fuelCapacity = ship.Attributes().Get(FUEL_CAPACITY);
 		
 		const System *from = ship.GetSystem();
 		const bool systemHasFuel = from->HasFuelFor(ship) && fuelCapacity;
@@ -157,7 +186,7 @@ namespace {
 	{
 		if(!to || ship.Fuel() == 1. || !ship.GetSystem()->HasFuelFor(ship))
 			return false;
-		double fuelCapacity = ship.Attributes().Get("fuel capacity");
+		double fuelCapacity = ship.Attributes().Get(FUEL_CAPACITY);
 		if(!fuelCapacity)
 			return false;
 		double needed = ship.JumpFuel(to);
@@ -307,7 +336,7 @@ void AI::UpdateKeys(PlayerInfo &player, Command &clickCommands, bool isActive)
 	// Only toggle the "cloak" command if one of your ships has a cloaking device.
 	if(keyDown.Has(Command::CLOAK))
 		for(const auto &it : player.Ships())
-			if(!it->IsParked() && it->Attributes().Get("cloak"))
+			if(!it->IsParked() && it->Attributes().Get(CLOAK))
 			{
 				isCloaking = !isCloaking;
 				Messages::Add(isCloaking ? "Engaging cloaking device." : "Disengaging cloaking device.");
@@ -783,7 +812,7 @@ void AI::Step(const PlayerInfo &player)
 			MoveIndependent(*it, command);
 		else if(parent->GetSystem() != it->GetSystem())
 		{
-			if(personality.IsStaying() || !it->Attributes().Get("fuel capacity"))
+			if(personality.IsStaying() || !it->Attributes().Get(FUEL_CAPACITY))
 				MoveIndependent(*it, command);
 			else
 				MoveEscort(*it, command);
@@ -1056,19 +1085,19 @@ shared_ptr<Ship> AI::FindTarget(const Ship &ship) const
 		double range = (foe->Position() + 60. * foe->Velocity()).Distance(
 			ship.Position() + 60. * ship.Velocity());
 		// Prefer the previous target, or the parent's target, if they are nearby.
-		if(foe == oldTarget || foe == parentTarget)
+		if(foe == oldTarget.get() || foe == parentTarget.get())
 			range -= 500.;
 		
 		// Unless this ship is "heroic", it should not chase much stronger ships.
 		if(maxStrength && range > 1000. && !foe->IsDisabled())
 		{
-			const auto otherStrengthIt = shipStrength.find(foe.get());
+			const auto otherStrengthIt = shipStrength.find(foe);
 			if(otherStrengthIt != shipStrength.end() && otherStrengthIt->second > maxStrength)
 				continue;
 		}
 		
 		// Ships which only disable never target already-disabled ships.
-		if((person.Disables() || (!person.IsNemesis() && foe != oldTarget))
+		if((person.Disables() || (!person.IsNemesis() && foe != oldTarget.get()))
 				&& foe->IsDisabled() && !canPlunder)
 			continue;
 		
@@ -1077,7 +1106,7 @@ shared_ptr<Ship> AI::FindTarget(const Ship &ship) const
 			range += 5000. * foe->IsDisabled();
 		// While those that do, do so only if no "live" enemies are nearby.
 		else
-			range += 2000. * (2 * foe->IsDisabled() - !Has(ship, foe, ShipEvent::BOARD));
+			range += 2000. * (2 * foe->IsDisabled() - !Has(ship, foe->shared_from_this(), ShipEvent::BOARD));
 		
 		// Prefer to go after armed targets, especially if you're not a pirate.
 		range += 1000. * (!IsArmed(*foe) * (1 + !person.Plunders()));
@@ -1091,7 +1120,7 @@ shared_ptr<Ship> AI::FindTarget(const Ship &ship) const
 		if((isPotentialNemesis && !hasNemesis) || range < closest)
 		{
 			closest = range;
-			target = foe;
+			target = foe->shared_from_this();
 			isDisabled = foe->IsDisabled();
 			hasNemesis = isPotentialNemesis;
 		}
@@ -1100,24 +1129,24 @@ shared_ptr<Ship> AI::FindTarget(const Ship &ship) const
 	// AI ships without an in-range hostile target consider scanning other ships.
 	if(!isYours && !target)
 	{
-		bool cargoScan = ship.Attributes().Get("cargo scan power");
-		bool outfitScan = ship.Attributes().Get("outfit scan power");
+		bool cargoScan = ship.Attributes().Get(CARGO_SCAN_POWER);
+		bool outfitScan = ship.Attributes().Get(OUTFIT_SCAN_POWER);
 		if(cargoScan || outfitScan)
 		{
 			closest = numeric_limits<double>::infinity();
 			const auto allies = GetShipsList(ship, false);
-			for(const auto &it : allies)
+			for(Ship *it : allies)
 				if(it->GetGovernment() != gov)
 				{
-					if((!cargoScan || Has(gov, it, ShipEvent::SCAN_CARGO))
-							&& (!outfitScan || Has(gov, it, ShipEvent::SCAN_OUTFITS)))
+					if((!cargoScan || Has(gov, it->shared_from_this(), ShipEvent::SCAN_CARGO))
+							&& (!outfitScan || Has(gov, it->shared_from_this(), ShipEvent::SCAN_OUTFITS)))
 						continue;
 					
 					double range = it->Position().Distance(ship.Position());
 					if(range < closest)
 					{
 						closest = range;
-						target = it;
+						target = it->shared_from_this();
 					}
 				}
 		}
@@ -1132,7 +1161,7 @@ shared_ptr<Ship> AI::FindTarget(const Ship &ship) const
 	{
 		// Make sure the ship has somewhere to flee to.
 		const System *system = ship.GetSystem();
-		if(ship.JumpsRemaining() && (!system->Links().empty() || ship.Attributes().Get("jump drive")))
+		if(ship.JumpsRemaining() && (!system->Links().empty() || ship.Attributes().Get(JUMP_DRIVE)))
 			target.reset();
 		else
 			for(const StellarObject &object : system->Objects())
@@ -1161,12 +1190,12 @@ shared_ptr<Ship> AI::FindTarget(const Ship &ship) const
 // Return a list of all targetable ships in the same system as the player that
 // match the desired hostility (i.e. enemy or non-enemy). Does not consider the
 // ship's current target, as its inclusion may or may not be desired.
-vector<shared_ptr<Ship>> AI::GetShipsList(const Ship &ship, bool targetEnemies, double maxRange) const
+vector<Ship *> AI::GetShipsList(const Ship &ship, bool targetEnemies, double maxRange) const
 {
 	if(maxRange < 0.)
 		maxRange = numeric_limits<double>::infinity();
 	
-	auto targets = vector<shared_ptr<Ship>>();
+	auto targets = vector<Ship *>();
 	
 	// The cached lists are built each step based on the current ships in the player's system.
 	const auto &rosters = targetEnemies ? enemyLists : allyLists;
@@ -1174,17 +1203,21 @@ vector<shared_ptr<Ship>> AI::GetShipsList(const Ship &ship, bool targetEnemies,
 	const auto it = rosters.find(ship.GetGovernment());
 	if (it != rosters.end() && !it->second.empty())
 	{
-		targets.reserve(it->second.size());
-		
+		// The lists are sorted by x coordinate, so skip straight to the first
+		// ship that might be in range, and stop after the last one.
 		const System *here = ship.GetSystem();
 		const Point &p = ship.Position();
-		for(const auto &target : it->second)
-			if(target->IsTargetable() && target->GetSystem() == here
-					&& !(target->IsHyperspacing() && target->Velocity().Length() > 10.)
+		auto entry = lower_bound(it->second.begin(), it->second.end(), p.X() - maxRange,
+			[](const ListEntry &a, double x) { return a.x < x; });
+		for( ; entry != it->second.end() && entry->x <= p.X() + maxRange; ++entry)
+		{
+			Ship *target = entry->ship;
+			if(target->GetSystem() == here
 					&& p.Distance(target->Position()) < maxRange
 					&& (ship.IsYours() || !target->GetPersonality().IsMarked())
 					&& (target->IsYours() || !ship.GetPersonality().IsMarked()))
-				targets.emplace_back(target);
+				targets.push_back(target);
+		}
 	}
 	
 	return targets;
@@ -1298,8 +1331,8 @@ void AI::MoveIndependent(Ship &ship, Command &command) const
 	}
 	else if(target)
 	{
-		bool cargoScan = ship.Attributes().Get("cargo scan power");
-		bool outfitScan = ship.Attributes().Get("outfit scan power");
+		bool cargoScan = ship.Attributes().Get(CARGO_SCAN_POWER);
+		bool outfitScan = ship.Attributes().Get(OUTFIT_SCAN_POWER);
 		if((!cargoScan || Has(gov, target, ShipEvent::SCAN_CARGO))
 				&& (!outfitScan || Has(gov, target, ShipEvent::SCAN_OUTFITS)))
 			target.reset();
@@ -1327,7 +1360,7 @@ void AI::MoveIndependent(Ship &ship, Command &command) const
 		
 		vector<int> systemWeights;
 		int totalWeight = 0;
-		const set<const System *> &links = ship.Attributes().Get("jump drive")
+		const set<const System *> &links = ship.Attributes().Get(JUMP_DRIVE)
 			? origin->Neighbors() : origin->Links();
 		if(jumps)
 		{
@@ -1412,7 +1445,7 @@ void AI::MoveIndependent(Ship &ship, Command &command) const
 	else if(ship.GetTargetStellar())
 	{
 		MoveToPlanet(ship, command);
-		if(!shouldStay && ship.Attributes().Get("fuel capacity")
+		if(!shouldStay && ship.Attributes().Get(FUEL_CAPACITY)
 				&& ship.GetTargetStellar()->GetPlanet() && ship.GetTargetStellar()->GetPlanet()->CanLand(ship))
 			command |= Command::LAND;
 		else if(ship.Position().Distance(ship.GetTargetStellar()->Position()) < 100.)
@@ -1430,7 +1463,7 @@ void AI::MoveIndependent(Ship &ship, Command &command) const
 void AI::MoveEscort(Ship &ship, Command &command) const
 {
 	const Ship &parent = *ship.GetParent();
-	bool hasFuelCapacity = ship.Attributes().Get("fuel capacity") && ship.JumpFuel();
+	bool hasFuelCapacity = ship.Attributes().Get(FUEL_CAPACITY) && ship.JumpFuel();
 	bool isStaying = ship.GetPersonality().IsStaying() || !hasFuelCapacity;
 	bool parentIsHere = (ship.GetSystem() == parent.GetSystem());
 	// Check if the parent has a target planet that is in the parent's system.
@@ -1580,9 +1613,9 @@ bool AI::ShouldDock(const Ship &ship, const Ship &parent, bool playerShipsLaunch
 	
 	// If a fighter has fuel capacity but is very low, it should return if
 	// the parent can refuel it.
-	double maxFuel = ship.Attributes().Get("fuel capacity");
+	double maxFuel = ship.Attributes().Get(FUEL_CAPACITY);
 	if(maxFuel && ship.Fuel() < .005 && parent.JumpFuel() < parent.Fuel() *
-			parent.Attributes().Get("fuel capacity") - maxFuel)
+			parent.Attributes().Get(FUEL_CAPACITY) - maxFuel)
 		return true;
 	
 	// If an out-of-combat NPC fighter is carrying a significant cargo
@@ -1694,7 +1727,7 @@ bool AI::Stop(Ship &ship, Command &command, double maxSpeed, const Point directi
 	
 	// If you have a reverse thruster, figure out whether using it is faster
 	// than turning around and using your main thruster.
-	if(ship.Attributes().Get("reverse thrust"))
+	if(ship.Attributes().Get(REVERSE_THRUST))
 	{
 		// Figure out your stopping time using your main engine:
 		double degreesToTurn = TO_DEG * acos(min(1., max(-1., -velocity.Unit().Dot(angle.Unit()))));
@@ -1702,7 +1735,7 @@ bool AI::Stop(Ship &ship, Command &command, double maxSpeed, const Point directi
 		forwardTime += stopTime;
 		
 		// Figure out your reverse thruster stopping time:
-		double reverseAcceleration = ship.Attributes().Get("reverse thrust") / ship.Mass();
+		double reverseAcceleration = ship.Attributes().Get(REVERSE_THRUST) / ship.Mass();
 		double reverseTime = (180. - degreesToTurn) / ship.TurnRate();
 		reverseTime += speed / reverseAcceleration;
 		
@@ -1740,9 +1773,9 @@ bool AI::Stop(Ship &ship, Command &command, double maxSpeed, const Point directi
 
 void AI::PrepareForHyperspace(Ship &ship, Command &command)
 {
-	bool hasHyperdrive = ship.Attributes().Get("hyperdrive");
-	double scramThreshold = ship.Attributes().Get("scram drive");
-	bool hasJumpDrive = ship.Attributes().Get("jump drive");
+	bool hasHyperdrive = ship.Attributes().Get(HYPERDRIVE);
+	double scramThreshold = ship.Attributes().Get(SCRAM_DRIVE);
+	bool hasJumpDrive = ship.Attributes().Get(JUMP_DRIVE);
 	if(!hasHyperdrive && !hasJumpDrive)
 		return;
 	
@@ -1782,9 +1815,9 @@ void AI::PrepareForHyperspace(Ship &ship, Command &command)
 	}
 	// If we're a jump drive, just stop.
 	else if(isJump)
-		Stop(ship, command, ship.Attributes().Get("jump speed"));
+		Stop(ship, command, ship.Attributes().Get(JUMP_SPEED));
 	// Else stop in the fastest way to end facing in the right direction
-	else if(Stop(ship, command, ship.Attributes().Get("jump speed"), direction))
+	else if(Stop(ship, command, ship.Attributes().Get(JUMP_SPEED), direction))
 		command.SetTurn(TurnToward(ship, direction));
 }
 
@@ -1887,12 +1920,12 @@ void AI::KeepStation(Ship &ship, Command &command, const Ship &target)
 		command.SetTurn(targetAngle);
 	
 	// Determine whether to apply thrust.
-	Point drag = ship.Velocity() * (ship.Attributes().Get("drag") / mass);
-	if(ship.Attributes().Get("reverse thrust"))
+	Point drag = ship.Velocity() * (ship.Attributes().Get(DRAG) / mass);
+	if(ship.Attributes().Get(REVERSE_THRUST))
 	{
 		// Don't take drag into account when reverse thrusting, because this
 		// estimate of how it will be applied can be quite inaccurate.
-		Point a = (unit * (-ship.Attributes().Get("reverse thrust") / mass)).Unit();
+		Point a = (unit * (-ship.Attributes().Get(REVERSE_THRUST) / mass)).Unit();
 		double direction = positionWeight * positionDelta.Dot(a) / POSITION_DEADBAND
 			+ velocityWeight * velocityDelta.Dot(a) / VELOCITY_DEADBAND;
 		if(direction > THRUST_DEADBAND)
@@ -2039,18 +2072,18 @@ void AI::PickUp(Ship &ship, Command &command, const Body &target)
 // energy strain, or undue thermal loads if almost overheated.
 bool AI::ShouldUseAfterburner(Ship &ship)
 {
-	if(!ship.Attributes().Get("afterburner thrust"))
+	if(!ship.Attributes().Get(AFTERBURNER_THRUST))
 		return false;
 	
-	double fuel = ship.Fuel() * ship.Attributes().Get("fuel capacity");
-	double neededFuel = ship.Attributes().Get("afterburner fuel");
-	double energy = ship.Energy() * ship.Attributes().Get("energy capacity");
-	double neededEnergy = ship.Attributes().Get("afterburner energy");
+	double fuel = ship.Fuel() * ship.Attributes().Get(FUEL_CAPACITY);
+	double neededFuel = ship.Attributes().Get(AFTERBURNER_FUEL);
+	double energy = ship.Energy() * ship.Attributes().Get(ENERGY_CAPACITY);
+	double neededEnergy = ship.Attributes().Get(AFTERBURNER_ENERGY);
 	if(energy == 0.)
-		energy = ship.Attributes().Get("energy generation")
-				+ 0.2 * ship.Attributes().Get("solar collection")
-				- ship.Attributes().Get("energy consumption");
-	double outputHeat = ship.Attributes().Get("afterburner heat") / (100 * ship.Mass());
+		energy = ship.Attributes().Get(ENERGY_GENERATION)
+				+ 0.2 * ship.Attributes().Get(SOLAR_COLLECTION)
+				- ship.Attributes().Get(ENERGY_CONSUMPTION);
+	double outputHeat = ship.Attributes().Get(AFTERBURNER_HEAT) / (100 * ship.Mass());
 	if((!neededFuel || fuel - neededFuel > ship.JumpFuel())
 			&& (!neededEnergy || neededEnergy / energy < 0.25)
 			&& (!outputHeat || ship.Heat() + outputHeat < .9))
@@ -2085,14 +2118,14 @@ void AI::DoSwarming(Ship &ship, Command &command, shared_ptr<Ship> &target)
 		int lowestCount = 7;
 		// Consider swarming around non-hostile ships in the same system.
 		const auto others = GetShipsList(ship, false);
-		for(const shared_ptr<Ship> &other : others)
+		for(Ship *other : others)
 			if(!other->GetPersonality().IsSwarming())
 			{
 				// Prefer to swarm ships that are not already being heavily swarmed.
-				int count = swarmCount[other.get()] + Random::Int(4);
+				int count = swarmCount[other] + Random::Int(4);
 				if(count < lowestCount)
 				{
-					target = other;
+					target = other->shared_from_this();
 					lowestCount = count;
 				}
 			}
@@ -2142,7 +2175,7 @@ void AI::DoSurveillance(Ship &ship, Command &command, shared_ptr<Ship> &target)
 	{
 		// Approach the planet and "land" on it (i.e. scan it).
 		MoveToPlanet(ship, command);
-		double atmosphereScan = ship.Attributes().Get("atmosphere scan");
+		double atmosphereScan = ship.Attributes().Get(ATMOSPHERE_SCAN);
 		double distance = ship.Position().Distance(ship.GetTargetStellar()->Position());
 		if(distance < atmosphereScan && !Random::Int(100))
 			ship.SetTargetStellar(nullptr);
@@ -2152,8 +2185,8 @@ void AI::DoSurveillance(Ship &ship, Command &command, shared_ptr<Ship> &target)
 	else if(target)
 	{
 		// Approach and scan the targeted, friendly ship's cargo or outfits.
-		bool cargoScan = ship.Attributes().Get("cargo scan power");
-		bool outfitScan = ship.Attributes().Get("outfit scan power");
+		bool cargoScan = ship.Attributes().Get(CARGO_SCAN_POWER);
+		bool outfitScan = ship.Attributes().Get(OUTFIT_SCAN_POWER);
 		// If the pointer to the target ship exists, it is targetable and in-system.
 		bool mustScanCargo = cargoScan && !Has(ship, target, ShipEvent::SCAN_CARGO);
 		bool mustScanOutfits = outfitScan && !Has(ship, target, ShipEvent::SCAN_OUTFITS);
@@ -2172,8 +2205,8 @@ void AI::DoSurveillance(Ship &ship, Command &command, shared_ptr<Ship> &target)
 		
 		// Consider scanning any non-hostile ship in this system that you haven't yet personally scanned.
 		vector<shared_ptr<Ship>> targetShips;
-		bool cargoScan = ship.Attributes().Get("cargo scan power");
-		bool outfitScan = ship.Attributes().Get("outfit scan power");
+		bool cargoScan = ship.Attributes().Get(CARGO_SCAN_POWER);
+		bool outfitScan = ship.Attributes().Get(OUTFIT_SCAN_POWER);
 		if(cargoScan || outfitScan)
 			for(const auto &grit : governmentRosters)
 			{
@@ -2192,7 +2225,7 @@ void AI::DoSurveillance(Ship &ship, Command &command, shared_ptr<Ship> &target)
 		
 		// Consider scanning any planetary object in the system, if able.
 		vector<const StellarObject *> targetPlanets;
-		double atmosphereScan = ship.Attributes().Get("atmosphere scan");
+		double atmosphereScan = ship.Attributes().Get(ATMOSPHERE_SCAN);
 		if(atmosphereScan)
 			for(const StellarObject &object : system->Objects())
 				if(!object.IsStar() && !object.IsStation())
@@ -2202,7 +2235,7 @@ void AI::DoSurveillance(Ship &ship, Command &command, shared_ptr<Ship> &target)
 		vector<const System *> targetSystems;
 		if(ship.JumpsRemaining())
 		{
-			const auto &links  = ship.Attributes().Get("jump drive") ? system->Neighbors() : system->Links();
+			const auto &links  = ship.Attributes().Get(JUMP_DRIVE) ? system->Neighbors() : system->Links();
 			targetSystems.insert(targetSystems.end(), links.begin(), links.end());
 		}
 		
@@ -2343,15 +2376,15 @@ bool AI::DoHarvesting(Ship &ship, Command &command)
 // Check if this ship should cloak. Returns true if this ship decided to run away while cloaking.
 bool AI::DoCloak(Ship &ship, Command &command)
 {
-	if(ship.Attributes().Get("cloak"))
+	if(ship.Attributes().Get(CLOAK))
 	{
 		// Never cloak if it will cause you to be stranded.
 		const Outfit &attributes = ship.Attributes();
-		double fuelCost = attributes.Get("cloaking fuel") + attributes.Get("fuel consumption") - attributes.Get("fuel generation");
-		if(attributes.Get("cloaking fuel") && !attributes.Get("ramscoop"))
+		double fuelCost = attributes.Get(CLOAKING_FUEL) + attributes.Get(FUEL_CONSUMPTION) - attributes.Get(FUEL_GENERATION);
+		if(attributes.Get(CLOAKING_FUEL) && !attributes.Get(RAMSCOOP))
 		{
-			double fuel = ship.Fuel() * attributes.Get("fuel capacity");
-			int steps = ceil((1. - ship.Cloaking()) / attributes.Get("cloak"));
+			double fuel = ship.Fuel() * attributes.Get(FUEL_CAPACITY);
+			int steps = ceil((1. - ship.Cloaking()) / attributes.Get(CLOAK));
 			// Only cloak if you will be able to fully cloak and also maintain it
 			// for as long as it will take you to reach full cloak.
 			fuel -= fuelCost * (1 + 2 * steps);
@@ -2372,10 +2405,10 @@ bool AI::DoCloak(Ship &ship, Command &command)
 		// Otherwise, always cloak if you are in imminent danger.
 		static const double MAX_RANGE = 10000.;
 		double range = MAX_RANGE;
-		shared_ptr<const Ship> nearestEnemy;
+		const Ship *nearestEnemy = nullptr;
 		// Find the nearest targetable, in-system enemy that could attack this ship.
-		const auto enemies = GetShipsList(ship, true);
-		for(const auto &foe : enemies)
+		const auto enemies = GetShipsList(ship, true, MAX_RANGE);
+		for(const Ship *foe : enemies)
 			if(!foe->IsDisabled())
 			{
 				double distance = ship.Position().Distance(foe->Position());
@@ -2393,7 +2426,7 @@ bool AI::DoCloak(Ship &ship, Command &command)
 		bool cloakFreely = (fuelCost <= 0.) && !ship.GetShipToAssist();
 		// If this ship is injured / repairing, it should cloak while under threat.
 		bool cloakToRepair = (ship.Health() < RETREAT_HEALTH + hysteresis)
-				&& (attributes.Get("shield generation") || attributes.Get("hull repair rate"));
+				&& (attributes.Get(SHIELD_GENERATION) || attributes.Get(HULL_REPAIR_RATE));
 		if(cloakToRepair && (cloakFreely || range < 2000. * (1. + hysteresis)))
 		{
 			command |= Command::CLOAK;
@@ -2490,10 +2523,10 @@ Point AI::StoppingPoint(const Ship &ship, const Point &targetVelocity, bool &sho
 	// The average term's value will be v / 2. So:
 	stopDistance += .5 * v * v / acceleration;
 	
-	if(ship.Attributes().Get("reverse thrust"))
+	if(ship.Attributes().Get(REVERSE_THRUST))
 	{
 		// Figure out your reverse thruster stopping distance:
-		double reverseAcceleration = ship.Attributes().Get("reverse thrust") / ship.Mass();
+		double reverseAcceleration = ship.Attributes().Get(REVERSE_THRUST) / ship.Mass();
 		double reverseDistance = v * (180. - degreesToTurn) / turnRate;
 		reverseDistance += .5 * v * v / reverseAcceleration;
 		
@@ -2577,11 +2610,11 @@ void AI::AimTurrets(const Ship &ship, Command &command, bool opportunistic) cons
 		
 		// Now, find all enemy ships within that radius.
 		auto enemies = GetShipsList(ship, true, maxRange);
-		// Convert the shared_ptr<Ship> into const Body *, to allow aiming turrets
+		// Convert the Ship * into const Body *, to allow aiming turrets
 		// at a targeted asteroid. Skip disabled ships, which pose no threat.
-		for(const shared_ptr<Ship> &ship : enemies)
+		for(const Ship *ship : enemies)
 			if(!ship->IsDisabled())
-				targets.emplace_back(ship.get());
+				targets.emplace_back(ship);
 		// Even if the ship's current target ship is beyond maxRange,
 		// or is already disabled, consider aiming at it.
 		if(currentTarget && currentTarget->IsTargetable()
@@ -2759,8 +2792,8 @@ void AI::AutoFire(const Ship &ship, Command &command, bool secondary) const
 	// Consider the current target if it is not already considered (i.e. it
 	// is a friendly ship and this is a player ship ordered to attack it).
 	if(currentTarget && currentTarget->IsTargetable()
-			&& find(enemies.cbegin(), enemies.cend(), currentTarget) == enemies.cend())
-		enemies.push_back(currentTarget);
+			&& find(enemies.cbegin(), enemies.cend(), currentTarget.get()) == enemies.cend())
+		enemies.push_back(currentTarget.get());
 	
 	int index = -1;
 	for(const Hardpoint &hardpoint : ship.Weapons())
@@ -2788,7 +2821,7 @@ void AI::AutoFire(const Ship &ship, Command &command, bool secondary) const
 		// fuel that you cannot leave the system if necessary.
 		if(weapon->FiringFuel())
 		{
-			double fuel = ship.Fuel() * ship.Attributes().Get("fuel capacity");
+			double fuel = ship.Fuel() * ship.Attributes().Get(FUEL_CAPACITY);
 			fuel -= weapon->FiringFuel();
 			// If the ship is not ever leaving this system, it does not need to
 			// reserve any fuel.
@@ -2839,11 +2872,11 @@ void AI::AutoFire(const Ship &ship, Command &command, bool secondary) const
 			continue;
 		}
 		// For non-homing weapons:
-		for(const shared_ptr<const Ship> &target : enemies)
+		for(const Ship *target : enemies)
 		{
 			// Don't shoot ships we want to plunder.
-			bool hasBoarded = Has(ship, target, ShipEvent::BOARD);
-			if(target->IsDisabled() && spareDisabled && !hasBoarded && !disabledOverride)
+			if(target->IsDisabled() && spareDisabled && !disabledOverride
+					&& !Has(ship, target->shared_from_this(), ShipEvent::BOARD))
 				continue;
 			
 			Point p = target->Position() - start;
@@ -3079,7 +3112,7 @@ void AI::MovePlayer(Ship &ship, const PlayerInfo &player)
 				}
 			}
 		// If no ship was found, look for nearby asteroids.
-		double asteroidRange = 100. * sqrt(ship.Attributes().Get("asteroid scan power"));
+		double asteroidRange = 100. * sqrt(ship.Attributes().Get(ASTEROID_SCAN_POWER));
 		if(!found && asteroidRange)
 		{
 			for(const shared_ptr<Minable> &asteroid : minables)
@@ -3271,7 +3304,7 @@ void AI::MovePlayer(Ship &ship, const PlayerInfo &player)
 		if(!ship.GetTargetSystem() && !isWormhole)
 		{
 			double bestMatch = -2.;
-			const auto &links = (ship.Attributes().Get("jump drive") ?
+			const auto &links = (ship.Attributes().Get(JUMP_DRIVE) ?
 				ship.GetSystem()->Neighbors() : ship.GetSystem()->Links());
 			for(const System *link : links)
 			{
@@ -3316,7 +3349,7 @@ void AI::MovePlayer(Ship &ship, const PlayerInfo &player)
 			command.SetTurn(keyHeld.Has(Command::RIGHT) - keyHeld.Has(Command::LEFT));
 		if(keyHeld.Has(Command::BACK))
 		{
-			if(!keyHeld.Has(Command::FORWARD) && ship.Attributes().Get("reverse thrust"))
+			if(!keyHeld.Has(Command::FORWARD) && ship.Attributes().Get(REVERSE_THRUST))
 				command |= Command::BACK;
 			else if(!keyHeld.Has(Command::RIGHT | Command::LEFT))
 				command.SetTurn(TurnBackward(ship));
@@ -3404,7 +3437,7 @@ void AI::MovePlayer(Ship &ship, const PlayerInfo &player)
 	else if(keyStuck.Has(Command::JUMP))
 	{
 		bool isNewPress = keyDown.Has(Command::JUMP) || !keyHeld.Has(Command::JUMP);
-		if(!ship.Attributes().Get("hyperdrive") && !ship.Attributes().Get("jump drive"))
+		if(!ship.Attributes().Get(HYPERDRIVE) && !ship.Attributes().Get(JUMP_DRIVE))
 		{
 			Messages::Add("You do not have a hyperdrive installed.");
 			keyStuck.Clear();
@@ -3565,17 +3598,32 @@ void AI::CacheShipLists()
 {
 	allyLists.clear();
 	enemyLists.clear();
+	
+	// Gather all the targetable ships that are not leaving the system (which
+	// cannot change until the ships move again), and sort them by x coordinate.
+	// Each government's lists are then filled in that order, so they stay sorted.
+	vector<ListEntry> targetable;
+	for(const auto &git : governmentRosters)
+		for(const shared_ptr<Ship> &it : git.second)
+			if(it->IsTargetable() && !(it->IsHyperspacing() && it->Velocity().Length() > 10.))
+				targetable.push_back({it->Position().X(), it.get()});
+	sort(targetable.begin(), targetable.end(),
+		[](const ListEntry &a, const ListEntry &b) { return a.x < b.x; });
+	
+	map<const Government *, bool> isEnemy;
 	for(const auto &git : governmentRosters)
 	{
-		allyLists.emplace(git.first, vector<shared_ptr<Ship>>());
-		allyLists.at(git.first).reserve(ships.size());
-		enemyLists.emplace(git.first, vector<shared_ptr<Ship>>());
-		enemyLists.at(git.first).reserve(ships.size());
 		for(const auto &oit : governmentRosters)
+			isEnemy[oit.first] = git.first->IsEnemy(oit.first);
+		
+		vector<ListEntry> &enemies = enemyLists[git.first];
+		vector<ListEntry> &allies = allyLists[git.first];
+		enemies.reserve(targetable.size());
+		allies.reserve(targetable.size());
+		for(const ListEntry &entry : targetable)
 		{
-			auto &list = git.first->IsEnemy(oit.first)
-					? enemyLists[git.first] : allyLists[git.first];
-			list.insert(list.end(), oit.second.begin(), oit.second.end());
+			auto &list = isEnemy[entry.ship->GetGovernment()] ? enemies : allies;
+			list.push_back(entry);
 		}
 	}
 }
@@ -81,7 +81,7 @@ private:
 	// Pick a new target for the given ship.
 	std::shared_ptr<Ship> FindTarget(const Ship &ship) const;
 	// Obtain a list of ships matching the desired hostility.
-	std::vector<std::shared_ptr<Ship>> GetShipsList(const Ship &ship, bool targetEnemies, double maxRange = -1.) const;
+	std::vector<Ship *> GetShipsList(const Ship &ship, bool targetEnemies, double maxRange = -1.) const;
 	
 	bool FollowOrders(Ship &ship, Command &command) const;
 	void MoveIndependent(Ship &ship, Command &command) const;
@@ -165,6 +165,15 @@ private:
 		Point point;
 		const System *targetSystem = nullptr;
 	};
+	
+	// An entry in the cached lists of targetable ships. Each list is sorted by
+	// x coordinate, so finding the ships within range of a given point only
+	// requires looking at the part of the list that spans that range.
+	class ListEntry {
+	public:
+		double x;
+		Ship *ship;
+	};
 
 
 private:
@@ -223,8 +232,8 @@ private:
 	std::map<const Government *, int64_t> enemyStrength;
 	std::map<const Government *, int64_t> allyStrength;
 	std::map<const Government *, std::vector<std::shared_ptr<Ship>>> governmentRosters;
-	std::map<const Government *, std::vector<std::shared_ptr<Ship>>> enemyLists;
-	std::map<const Government *, std::vector<std::shared_ptr<Ship>>> allyLists;
+	std::map<const Government *, std::vector<ListEntry>> enemyLists;
+	std::map<const Government *, std::vector<ListEntry>> allyLists;
 };
 
 
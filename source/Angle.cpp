@@ -158,6 +158,15 @@ double Angle::Degrees() const
 }
 
 
+
+// If the circle is divided into the given number of equal slices (which
+// must be a power of two), get the index of the slice this angle is in.
+int Angle::Slice(int slices) const
+{
+	return angle / (STEPS / slices);
+}
+
+
 	
 // Return a point rotated by this angle around (0, 0).
 Point Angle::Rotate(const Point &point) const
@@ -50,6 +50,10 @@ public:
 	Point Unit() const;
 	// Convert an Angle object to degrees, in the range -180 to 180.
 	double Degrees() const;
+	// If the circle is divided into the given number of equal slices (which
+	// must be a power of two), get the index of the slice this angle is in.
+	// Slice i starts at i * 360 / slices degrees.
+	int Slice(int slices) const;
 	
 	// Return a point rotated by this angle around (0, 0).
 	Point Rotate(const Point &point) const;
@@ -34,9 +34,11 @@ namespace {
 
 
 
-// Constructor, to set up the collision set parameters.
+// Constructor, to set up the collision set parameters. Ordinary asteroids are
+// spread evenly over the wrap square, which a grid of the same size matches
+// exactly. Minables can drift anywhere in the system, so they use a sweep.
 AsteroidField::AsteroidField()
-	: asteroidCollisions(CELL_SIZE, CELL_COUNT), minableCollisions(CELL_SIZE, CELL_COUNT)
+	: asteroidCollisions(CELL_SIZE, CELL_COUNT), minableCollisions(CollisionSet::SWEEP)
 {
 }
 
@@ -119,9 +121,10 @@ void AsteroidField::Draw(DrawList &draw, const Point &center, double zoom) const
 
 
 // Check if the given projectile collides with any asteroids.
-Body *AsteroidField::Collide(const Projectile &projectile, double *closestHit)
+Body *AsteroidField::Collide(const Projectile &projectile, double *closestHit, Minable **minable) const
 {
 	Body *hit = nullptr;
+	*minable = nullptr;
 	
 	// First, check for collisions with ordinary asteroids, which are tiled.
 	// Rather than tiling the collision set, tile the projectile.
@@ -157,7 +160,7 @@ Body *AsteroidField::Collide(const Projectile &projectile, double *closestHit)
 	if(body)
 	{
 		hit = body;
-		reinterpret_cast<Minable *>(body)->TakeDamage(projectile);
+		*minable = reinterpret_cast<Minable *>(body);
 	}
 	return hit;
 }
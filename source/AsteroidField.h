@@ -56,7 +56,10 @@ public:
 	void Draw(DrawList &draw, const Point &center, double zoom) const;
 	// Check if the given projectile has hit any of the asteroids, using the information
 	// in the collision sets. If a collision occurs, returns a pointer to the hit body.
-	Body *Collide(const Projectile &projectile, double *closestHit);
+	// If that is a minable asteroid, it is also stored in "minable" so that the
+	// caller can damage it. This does not modify the field, so it may be called
+	// from multiple threads at once.
+	Body *Collide(const Projectile &projectile, double *closestHit, Minable **minable) const;
 	
 	// Get the list of minable asteroids.
 	const std::list<std::shared_ptr<Minable>> &Minables() const;
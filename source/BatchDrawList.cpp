@@ -17,18 +17,27 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Screen.h"
 #include "Sprite.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace std;
 
 namespace {
-	void Push(vector<float> &v, const Point &pos, float s, float t, float frame)
+	// Add a vertex, given its position and its texture coordinates relative to
+	// the corner of the frame. Each of the two frames to blend between may be in
+	// a different place in the texture.
+	void Push(float *&v, const Point &pos, float s, float t,
+		const float *first, const float *second, const float *rect, float fade)
 	{
-		v.push_back(pos.X());
-		v.push_back(pos.Y());
-		v.push_back(s);
-		v.push_back(t);
-		v.push_back(frame);
+		*v++ = pos.X();
+		*v++ = pos.Y();
+		*v++ = first[0] + s * rect[2];
+		*v++ = first[1] + t * rect[3];
+		*v++ = first[2];
+		*v++ = second[0] + s * rect[2];
+		*v++ = second[1] + t * rect[3];
+		*v++ = second[2];
+		*v++ = fade;
 	}
 }
 
@@ -38,6 +47,7 @@ namespace {
 void BatchDrawList::Clear(int step, double zoom)
 {
 	data.clear();
+	quads.clear();
 	this->step = step;
 	this->zoom = zoom;
 	isHighDPI = (Screen::IsHighResolution() ? zoom > .5 : zoom > 1.);
@@ -59,10 +69,20 @@ bool BatchDrawList::Add(const Body &body, float clip)
 	if(Cull(body, position))
 		return false;
 	
-	// Get the data vector for this particular sprite.
-	vector<float> &v = data[body.GetSprite()];
-	// The sprite frame is the same for every vertex.
+	// Remember which texture this quad uses.
+	const Sprite *sprite = body.GetSprite();
+	const Sprite::Layout *layout;
+	quads.emplace_back(sprite->Texture(isHighDPI, layout), quads.size());
+	
+	// The sprite frame is the same for every vertex. Find where in the texture
+	// the two frames to blend between are.
 	float frame = body.GetFrame(step);
+	float floored = floor(frame);
+	float first[3];
+	float second[3];
+	layout->Corner(floored, first);
+	layout->Corner(static_cast<int>(ceil(frame)) % max(1, sprite->Frames()), second);
+	float fade = frame - floored;
 	
 	// Get unit vectors in the direction of the object's width and height.
 	Point unit = body.Unit() * zoom;
@@ -80,14 +100,12 @@ bool BatchDrawList::Add(const Body &body, float clip)
 	Point bottomLeft = topLeft + uh;
 	Point bottomRight = bottomLeft + uw;
 	
-	// Push two copies of the first and last vertices to mark the break between
-	// the sprites.
-	Push(v, topLeft, 0.f, 1.f, frame);
-	Push(v, topLeft, 0.f, 1.f, frame);
-	Push(v, topRight, 1.f, 1.f, frame);
-	Push(v, bottomLeft, 0.f, 1.f - clip, frame);
-	Push(v, bottomRight, 1.f, 1.f - clip, frame);
-	Push(v, bottomRight, 1.f, 1.f - clip, frame);
+	data.resize(data.size() + BatchShader::QUAD_FLOATS);
+	float *v = &data.back() + 1 - BatchShader::QUAD_FLOATS;
+	Push(v, topLeft, 0.f, 1.f, first, second, layout->rect, fade);
+	Push(v, topRight, 1.f, 1.f, first, second, layout->rect, fade);
+	Push(v, bottomLeft, 0.f, 1.f - clip, first, second, layout->rect, fade);
+	Push(v, bottomRight, 1.f, 1.f - clip, first, second, layout->rect, fade);
 	
 	return true;
 }
@@ -97,10 +115,32 @@ bool BatchDrawList::Add(const Body &body, float clip)
 // Draw all the items in this list.
 void BatchDrawList::Draw() const
 {
+	if(quads.empty())
+		return;
+	
+	// Group the quads by texture. Within each texture they stay in the order in
+	// which they were added. Sort a copy so that drawing does not modify the list.
+	vector<pair<uint32_t, uint32_t>> order = quads;
+	sort(order.begin(), order.end());
+	
 	BatchShader::Bind();
 	
-	for(const pair<const Sprite *, vector<float>> &it : data)
-		BatchShader::Add(it.first, isHighDPI, it.second);
+	// Upload the vertex data for all the sprites at once.
+	float *out = BatchShader::Map(order.size());
+	for(const pair<uint32_t, uint32_t> &it : order)
+		out = copy_n(data.begin() + it.second * BatchShader::QUAD_FLOATS, BatchShader::QUAD_FLOATS, out);
+	BatchShader::Unmap();
+	
+	for(size_t first = 0; first < order.size(); )
+	{
+		uint32_t texture = order[first].first;
+		size_t last = first + 1;
+		while(last < order.size() && order[last].first == texture)
+			++last;
+		
+		BatchShader::Add(texture, first, last - first);
+		first = last;
+	}
 	
 	BatchShader::Unbind();
 }
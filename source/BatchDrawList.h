@@ -15,7 +15,8 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Point.h"
 
-#include <map>
+#include <cstdint>
+#include <utility>
 #include <vector>
 
 class Body;
@@ -24,7 +25,8 @@ class Sprite;
 
 
 // This class collects a set of OpenGL draw commands to issue and groups them by
-// sprite, so all instances of each sprite can be drawn with a single command.
+// texture, so all instances of each sprite (and of any small sprites that share
+// an atlas texture) can be drawn with a single command.
 class BatchDrawList {
 public:
 	// Clear the list, also setting the global time step for animation.
@@ -48,11 +50,13 @@ private:
 	bool isHighDPI = false;
 	Point center;
 	
-	// Each sprite consists of six vertices (four vertices to form a quad and
-	// two dummy vertices to mark the break in between them). Each of those
-	// vertices has five attributes: (x, y) position in pixels, (s, t) texture
-	// coordinates, and the index of the sprite frame.
-	std::map<const Sprite *, std::vector<float>> data;
+	// Each sprite is drawn as a quad of four vertices, in the layout that the
+	// BatchShader expects. The quads are stored in the order they were added,
+	// along with a list of which texture each one uses. When drawing, a copy of
+	// that list is sorted so that all the quads for each texture are uploaded
+	// together.
+	std::vector<float> data;
+	std::vector<std::pair<uint32_t, uint32_t>> quads;
 };
 
 
@@ -14,7 +14,9 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Screen.h"
 #include "Shader.h"
-#include "Sprite.h"
+
+#include <algorithm>
+#include <vector>
 
 using namespace std;
 
@@ -22,13 +24,90 @@ namespace {
 	Shader shader;
 	// Uniforms:
 	GLint scaleI;
-	GLint frameCountI;
 	// Vertex data:
 	GLint vertI;
-	GLint texCoordI;
+	GLint firstI;
+	GLint secondI;
+	GLint fadeI;
 	
 	GLuint vao;
 	GLuint vbo;
+	GLuint ebo;
+	// Number of quads the index buffer currently has indices for.
+	size_t indexQuads = 0;
+	
+	// If persistent buffer mapping is available, the vertex stream is a ring
+	// of segments. The CPU writes into one segment while the GPU may still be
+	// drawing from the others, and a fence marks when each one is free again.
+	const int SEGMENTS = 3;
+	bool useStorage = false;
+	size_t segmentQuads = 0;
+	float *mapped = nullptr;
+	GLsync fence[SEGMENTS] = {};
+	int segment = 0;
+	bool isMapped = false;
+	// Otherwise, the data is staged in memory and the buffer is orphaned and
+	// re-specified each time it is uploaded.
+	vector<float> staging;
+	
+	
+	// Point the vertex attributes at the given byte offset in the stream.
+	void SetOffset(size_t offset)
+	{
+		const char *base = reinterpret_cast<const char *>(offset);
+		const GLsizei stride = 9 * sizeof(float);
+		glVertexAttribPointer(vertI, 2, GL_FLOAT, GL_FALSE, stride, base);
+		glVertexAttribPointer(firstI, 3, GL_FLOAT, GL_FALSE, stride, base + 2 * sizeof(float));
+		glVertexAttribPointer(secondI, 3, GL_FLOAT, GL_FALSE, stride, base + 5 * sizeof(float));
+		glVertexAttribPointer(fadeI, 1, GL_FLOAT, GL_FALSE, stride, base + 8 * sizeof(float));
+	}
+	
+	
+	// Make sure the index buffer covers at least the given number of quads.
+	// Each quad is drawn as two triangles sharing the diagonal, with their
+	// vertices in the same order that a triangle strip would use.
+	void ReserveIndices(size_t quads)
+	{
+		if(quads <= indexQuads)
+			return;
+		
+		indexQuads = max(quads, 2 * indexQuads);
+		vector<GLuint> indices;
+		indices.reserve(6 * indexQuads);
+		for(GLuint i = 0; i < 4 * indexQuads; i += 4)
+			for(GLuint corner : {1, 0, 2, 1, 2, 3})
+				indices.push_back(i + corner);
+		
+		// The element buffer binding is part of the VAO state, which is bound.
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indices.size(), indices.data(), GL_STATIC_DRAW);
+	}
+	
+	
+	// Make sure each segment of the persistent stream can hold the given
+	// number of quads. Growing it means creating a new buffer, because the
+	// storage of a buffer can only be allocated once.
+	void ReserveStorage(size_t quads)
+	{
+		if(quads <= segmentQuads)
+			return;
+		
+		for(GLsync &it : fence)
+			if(it)
+			{
+				glDeleteSync(it);
+				it = nullptr;
+			}
+		glDeleteBuffers(1, &vbo);
+		
+		segmentQuads = max(quads, 2 * segmentQuads);
+		GLsizeiptr size = SEGMENTS * segmentQuads * BatchShader::QUAD_FLOATS * sizeof(float);
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glGenBuffers(1, &vbo);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+		mapped = reinterpret_cast<float *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+		segment = 0;
+	}
 }
 
 
@@ -39,39 +118,42 @@ void BatchShader::Init()
 	static const char *vertexCode =
 		"uniform vec2 scale;\n"
 		"in vec2 vert;\n"
-		"in vec3 texCoord;\n"
+		"in vec3 first;\n"
+		"in vec3 second;\n"
+		"in float fade;\n"
 		
-		"out vec3 fragTexCoord;\n"
+		"out vec3 fragFirst;\n"
+		"out vec3 fragSecond;\n"
+		"flat out float fragFade;\n"
 		
 		"void main() {\n"
 		"  gl_Position = vec4(vert * scale, 0, 1);\n"
-		"  fragTexCoord = texCoord;\n"
+		"  fragFirst = first;\n"
+		"  fragSecond = second;\n"
+		"  fragFade = fade;\n"
 		"}\n";
 	
 	static const char *fragmentCode =
 		"uniform sampler2DArray tex;\n"
-		"uniform float frameCount;\n"
 		
-		"in vec3 fragTexCoord;\n"
+		"in vec3 fragFirst;\n"
+		"in vec3 fragSecond;\n"
+		"flat in float fragFade;\n"
 		
 		"out vec4 finalColor;\n"
 		
 		"void main() {\n"
-		"  float first = floor(fragTexCoord.z);\n"
-		"  float second = mod(ceil(fragTexCoord.z), frameCount);\n"
-		"  float fade = fragTexCoord.z - first;\n"
-		"  finalColor = mix(\n"
-		"    texture(tex, vec3(fragTexCoord.xy, first)),\n"
-		"    texture(tex, vec3(fragTexCoord.xy, second)), fade);\n"
+		"  finalColor = mix(texture(tex, fragFirst), texture(tex, fragSecond), fragFade);\n"
 		"}\n";
 	
 	// Compile the shaders.
 	shader = Shader(vertexCode, fragmentCode);
 	// Get the indices of the uniforms and attributes.
 	scaleI = shader.Uniform("scale");
-	frameCountI = shader.Uniform("frameCount");
 	vertI = shader.Attrib("vert");
-	texCoordI = shader.Attrib("texCoord");
+	firstI = shader.Attrib("first");
+	secondI = shader.Attrib("second");
+	fadeI = shader.Attrib("fade");
 	
 	// Make sure we're using texture 0.
 	glUseProgram(shader.Object());
@@ -84,15 +166,23 @@ void BatchShader::Init()
 	
 	glGenBuffers(1, &vbo);
 	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glGenBuffers(1, &ebo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	
+	// In this VAO, enable the vertex arrays and specify their byte offsets.
+	for(GLint attrib : {vertI, firstI, secondI, fadeI})
+		glEnableVertexAttribArray(attrib);
+	SetOffset(0);
 	
-	// In this VAO, enable the two vertex arrays and specify their byte offsets.
-	glEnableVertexAttribArray(vertI);
-	glVertexAttribPointer(vertI, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
-	glEnableVertexAttribArray(texCoordI);
-	glVertexAttribPointer(texCoordI, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(2 * sizeof(float)));
+#ifdef __APPLE__
+	useStorage = false;
+#else
+	useStorage = GLEW_ARB_buffer_storage;
+#endif
 	
 	// Unbind the buffer and the VAO, but leave the vertex attrib arrays enabled
-	// in the VAO so they will be used when it is bound.
+	// in the VAO so they will be used when it is bound. (The element buffer
+	// stays bound to the VAO.)
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
 }
@@ -113,28 +203,70 @@ void BatchShader::Bind()
 
 
 
-void BatchShader::Add(const Sprite *sprite, bool isHighDPI, const vector<float> &data)
+// Get space in the vertex stream for the given number of quads.
+float *BatchShader::Map(size_t quads)
+{
+	ReserveIndices(quads);
+	if(!useStorage)
+	{
+		staging.resize(quads * QUAD_FLOATS);
+		return staging.data();
+	}
+	
+	ReserveStorage(quads);
+	segment = (segment + 1) % SEGMENTS;
+	// Wait for the GPU to finish drawing the last batch that used this segment.
+	if(fence[segment])
+	{
+		GLenum result;
+		do {
+			result = glClientWaitSync(fence[segment], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		} while(result == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(fence[segment]);
+		fence[segment] = nullptr;
+	}
+	isMapped = true;
+	return mapped + segment * segmentQuads * QUAD_FLOATS;
+}
+
+
+
+// Upload the data written since the call to Map().
+void BatchShader::Unmap()
+{
+	if(useStorage)
+		SetOffset(segment * segmentQuads * QUAD_FLOATS * sizeof(float));
+	else
+		glBufferData(GL_ARRAY_BUFFER, sizeof(float) * staging.size(), staging.data(), GL_STREAM_DRAW);
+}
+
+
+
+void BatchShader::Add(uint32_t texture, size_t first, size_t count)
 {
 	// Do nothing if there are no sprites to draw.
-	if(data.empty())
+	if(!count)
 		return;
 	
 	// First, bind the proper texture.
-	glBindTexture(GL_TEXTURE_2D_ARRAY, sprite->Texture(isHighDPI));
-	// The shader also needs to know how many frames the texture has.
-	glUniform1f(frameCountI, sprite->Frames());
-	
-	// Upload the vertex data.
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * data.size(), data.data(), GL_STREAM_DRAW);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
 	
-	// Draw all the vertices.
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, data.size() / 5);
+	// Draw the given range of quads.
+	const char *offset = reinterpret_cast<const char *>(6 * first * sizeof(GLuint));
+	glDrawElements(GL_TRIANGLES, 6 * count, GL_UNSIGNED_INT, offset);
 }
 
 
 
 void BatchShader::Unbind()
 {
+	// Mark when the GPU will be done with this segment of the vertex stream.
+	if(isMapped)
+	{
+		fence[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		isMapped = false;
+	}
+	
 	// Unbind everything in reverse order.
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
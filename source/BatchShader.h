@@ -13,21 +13,34 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef BATCH_SHADER_H_
 #define BATCH_SHADER_H_
 
-class Sprite;
+#include <cstddef>
+#include <cstdint>
 
-#include <vector>
 
 
-
-// Class for drawing sprites in a batch. The input to each draw command is a
-// sprite, whether it should be drawn high DPI, and the vertex data.
+// Class for drawing sprites in a batch. The vertex data for everything in the
+// batch is uploaded at once, and then each draw command specifies a texture
+// and a range of quads to draw with it. (Small sprites share atlas textures,
+// so one command may draw many different sprites.) Each quad is four vertices
+// (top left, top right, bottom left, bottom right), and each vertex has nine
+// attributes: (x, y) position in pixels, the texture coordinates and layer of
+// the two animation frames to blend between, and how much of the second one
+// to blend in.
 class BatchShader {
+public:
+	static const size_t QUAD_FLOATS = 36;
+	
+	
 public:
 	// Initialize the shaders.
 	static void Init();
 	
 	static void Bind();
-	static void Add(const Sprite *sprite, bool isHighDPI, const std::vector<float> &data);
+	// Get space in the vertex stream for the given number of quads. All the
+	// data must be written to it before calling Unmap(), which uploads it.
+	static float *Map(size_t quads);
+	static void Unmap();
+	static void Add(uint32_t texture, size_t first, size_t count);
 	static void Unbind();
 };
 
@@ -23,7 +23,6 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include <algorithm>
 #include <cstdlib>
 #include <numeric>
-#include <set>
 #include <string>
 
 using namespace std;
@@ -35,12 +34,17 @@ namespace {
 	constexpr int USED_MAX_VELOCITY = MAX_VELOCITY - 1;
 	// Warn the user only once about too-large projectile velocities.
 	bool warned = false;
+	// Number of recently examined objects a line query remembers so it does not
+	// test them again in the next grid cell. If an object is forgotten, the only
+	// cost is that its mask is checked twice.
+	constexpr int SEEN_SIZE = 16;
 }
 
 
-// Initialize a collision set. The cell size and cell count should both be
-// powers of two; otherwise, they are rounded down to a power of two.
+// Initialize a grid collision set. The cell size and cell count should both
+// be powers of two; otherwise, they are rounded down to a power of two.
 CollisionSet::CollisionSet(unsigned cellSize, unsigned cellCount)
+	: structure(GRID)
 {
 	// Right shift amount to convert from (x, y) location to grid (x, y).
 	SHIFT = 0u;
@@ -61,6 +65,18 @@ CollisionSet::CollisionSet(unsigned cellSize, unsigned cellCount)
 
 
 
+// Initialize a collision set with the given structure. A grid created this
+// way has 32 x 32 cells, each 256 pixels across.
+CollisionSet::CollisionSet(Structure structure)
+	: CollisionSet(256u, 32u)
+{
+	this->structure = structure;
+	// A sweep does not need the grid's bins.
+	Clear(0);
+}
+
+
+
 // Clear all objects in the set.
 void CollisionSet::Clear(int step)
 {
@@ -69,9 +85,12 @@ void CollisionSet::Clear(int step)
 	added.clear();
 	sorted.clear();
 	counts.clear();
+	bounds.clear();
+	maxWidth = 0.;
 	// The counts vector starts with two sentinel slots that will be used in the
 	// course of performing the radix sort.
-	counts.resize(CELLS * CELLS + 2u, 0u);
+	if(structure == GRID)
+		counts.resize(CELLS * CELLS + 2u, 0u);
 }
 
 
@@ -79,6 +98,20 @@ void CollisionSet::Clear(int step)
 // Add an object to the set.
 void CollisionSet::Add(Body &body)
 {
+	// Update the object's animation frame now, so that the queries only need to
+	// read it. This is what allows queries to be made from multiple threads.
+	body.GetMask(step);
+	
+	if(structure == SWEEP)
+	{
+		const Point &center = body.Position();
+		double radius = body.Radius();
+		bounds.emplace_back(&body, center.X() - radius, center.Y() - radius,
+			center.X() + radius, center.Y() + radius);
+		maxWidth = max(maxWidth, 2. * radius);
+		return;
+	}
+	
 	// Calculate the range of (x, y) grid coordinates this object covers.
 	int minX = static_cast<int>(body.Position().X() - body.Radius()) >> SHIFT;
 	int minY = static_cast<int>(body.Position().Y() - body.Radius()) >> SHIFT;
@@ -92,7 +125,7 @@ void CollisionSet::Add(Body &body)
 		for(int x = minX; x <= maxX; ++x)
 		{
 			auto gx = x & WRAP_MASK;
-			added.emplace_back(&body, x, y);
+			added.emplace_back(&body, x, y, minX, minY);
 			++counts[gy * CELLS + gx + 2];
 		}
 	}
@@ -103,6 +136,18 @@ void CollisionSet::Add(Body &body)
 // Finish adding objects (and organize them into the final lookup table).
 void CollisionSet::Finish()
 {
+	if(structure == SWEEP)
+	{
+		// Sort the objects by their leftmost extent. A query can then find the
+		// first object that might overlap it with a binary search, and stop as
+		// soon as it reaches objects that begin to the right of it.
+		sort(bounds.begin(), bounds.end(), [](const Bounds &a, const Bounds &b)
+		{
+			return a.minX < b.minX;
+		});
+		return;
+	}
+	
 	// Perform a partial sum to convert the counts of items in each bin into the
 	// index of the output element where that bin begins.
 	partial_sum(counts.begin(), counts.end(), counts.begin());
@@ -144,6 +189,31 @@ Body *CollisionSet::Line(const Projectile &projectile, double *closestHit) const
 // position or its entire expected trajectory (for the auto-firing AI).
 Body *CollisionSet::Line(const Point &from, const Point &to, double *closestHit,
 		const Government *pGov, const Body *target) const
+{
+	if(structure == SWEEP)
+		return SweepLine(from, to, closestHit, pGov, target);
+	return GridLine(from, to, closestHit, pGov, target);
+}
+
+
+
+// Get all objects within the given range of the given point. The objects
+// are stored in the given vector, replacing anything that was in it.
+void CollisionSet::Circle(const Point &center, double radius, vector<Body *> &result) const
+{
+	result.clear();
+	if(structure == SWEEP)
+		SweepCircle(center, radius, result);
+	else
+		GridCircle(center, radius, result);
+}
+
+
+
+// Find the closest object a line collides with, by walking through the grid
+// cells that the line passes through.
+Body *CollisionSet::GridLine(const Point &from, const Point &to, double *closestHit,
+		const Government *pGov, const Body *target) const
 {
 	int x = from.X();
 	int y = from.Y();
@@ -183,7 +253,7 @@ Body *CollisionSet::Line(const Point &from, const Point &to, double *closestHit,
 			if(it->body != target && iGov && pGov && !iGov->IsEnemy(pGov))
 				continue;
 			
-			const Mask &mask = it->body->GetMask(step);
+			const Mask &mask = it->body->GetMask();
 			Point offset = from - it->body->Position();
 			double range = mask.Collide(offset, to - from, it->body->Facing());
 			
@@ -208,7 +278,7 @@ Body *CollisionSet::Line(const Point &from, const Point &to, double *closestHit,
 			warned = true;
 		}
 		Point newEnd = from + pVelocity.Unit() * USED_MAX_VELOCITY;
-		return Line(from, newEnd, closestHit, pGov, target);
+		return GridLine(from, newEnd, closestHit, pGov, target);
 	}
 	
 	// When stepping from one grid cell to the next, we'll go in this direction.
@@ -232,8 +302,10 @@ Body *CollisionSet::Line(const Point &from, const Point &to, double *closestHit,
 	if(stepY > 0)
 		ry = fullScale - ry;
 	
-	// Keep track of which objects we've already considered.
-	set<const Body *> seen;
+	// Keep track of which objects we've recently considered. Only a few are
+	// remembered, in a ring, so that this does not need to allocate anything.
+	const Body *seen[SEEN_SIZE] = {};
+	int seenIndex = 0;
 	while(true)
 	{
 		// Examine all objects in the current grid cell.
@@ -247,9 +319,10 @@ Body *CollisionSet::Line(const Point &from, const Point &to, double *closestHit,
 			if(it->x != gx || it->y != gy)
 				continue;
 			
-			if(seen.count(it->body))
+			if(find(seen, seen + SEEN_SIZE, it->body) != seen + SEEN_SIZE)
 				continue;
-			seen.insert(it->body);
+			seen[seenIndex] = it->body;
+			seenIndex = (seenIndex + 1) % SEEN_SIZE;
 			
 			// Check if this projectile can hit this object. If either the
 			// projectile or the object has no government, it will always hit.
@@ -257,7 +330,7 @@ Body *CollisionSet::Line(const Point &from, const Point &to, double *closestHit,
 			if(it->body != target && iGov && pGov && !iGov->IsEnemy(pGov))
 				continue;
 			
-			const Mask &mask = it->body->GetMask(step);
+			const Mask &mask = it->body->GetMask();
 			Point offset = from - it->body->Position();
 			double range = mask.Collide(offset, to - from, it->body->Facing());
 			
@@ -312,8 +385,53 @@ Body *CollisionSet::Line(const Point &from, const Point &to, double *closestHit,
 
 
 
-// Get all objects within the given range of the given point.
-const vector<Body *> &CollisionSet::Circle(const Point &center, double radius) const
+// Find the closest object a line collides with, by checking every object
+// whose bounding box overlaps the line's bounding box.
+Body *CollisionSet::SweepLine(const Point &from, const Point &to, double *closestHit,
+		const Government *pGov, const Body *target) const
+{
+	double minX = min(from.X(), to.X());
+	double minY = min(from.Y(), to.Y());
+	double maxX = max(from.X(), to.X());
+	double maxY = max(from.Y(), to.Y());
+	
+	// Keep track of the closest collision found so far. If an external "closest
+	// hit" value was given, there is no need to check collisions farther out
+	// than that.
+	double closest = closestHit ? *closestHit : 1.;
+	Body *result = nullptr;
+	for(auto it = SweepStart(minX); it != bounds.end() && it->minX <= maxX; ++it)
+	{
+		if(it->maxX < minX || it->maxY < minY || it->minY > maxY)
+			continue;
+		
+		// Check if this projectile can hit this object. If either the
+		// projectile or the object has no government, it will always hit.
+		const Government *iGov = it->body->GetGovernment();
+		if(it->body != target && iGov && pGov && !iGov->IsEnemy(pGov))
+			continue;
+		
+		const Mask &mask = it->body->GetMask();
+		Point offset = from - it->body->Position();
+		double range = mask.Collide(offset, to - from, it->body->Facing());
+		
+		if(range < closest)
+		{
+			closest = range;
+			result = it->body;
+		}
+	}
+	
+	if(closest < 1. && closestHit)
+		*closestHit = closest;
+	return result;
+}
+
+
+
+// Find all objects within the given range of the given point, by checking
+// the grid cells the circle covers.
+void CollisionSet::GridCircle(const Point &center, double radius, vector<Body *> &result) const
 {
 	// Calculate the range of (x, y) grid coordinates this circle covers.
 	int minX = static_cast<int>(center.X() - radius) >> SHIFT;
@@ -321,9 +439,6 @@ const vector<Body *> &CollisionSet::Circle(const Point &center, double radius) c
 	int maxX = static_cast<int>(center.X() + radius) >> SHIFT;
 	int maxY = static_cast<int>(center.Y() + radius) >> SHIFT;
 	
-	// Keep track of which objects we've already considered.
-	set<const Body *> seen;
-	result.clear();
 	for(int y = minY; y <= maxY; ++y)
 	{
 		auto gy = y & WRAP_MASK;
@@ -341,16 +456,53 @@ const vector<Body *> &CollisionSet::Circle(const Point &center, double radius) c
 				if(it->x != x || it->y != y)
 					continue;
 				
-				if(seen.count(it->body))
+				// If this object is also in an earlier cell that the circle
+				// covers, it was already considered there.
+				if(it->x != max(it->minX, minX) || it->y != max(it->minY, minY))
 					continue;
-				seen.insert(it->body);
 				
-				const Mask &mask = it->body->GetMask(step);
+				const Mask &mask = it->body->GetMask();
 				Point offset = center - it->body->Position();
 				if(offset.Length() <= radius || mask.WithinRange(offset, it->body->Facing(), radius))
 					result.push_back(it->body);
 			}
 		}
 	}
-	return result;
+}
+
+
+
+// Find all objects within the given range of the given point, by checking
+// every object whose bounding box overlaps the circle's bounding box.
+void CollisionSet::SweepCircle(const Point &center, double radius, vector<Body *> &result) const
+{
+	double minX = center.X() - radius;
+	double minY = center.Y() - radius;
+	double maxX = center.X() + radius;
+	double maxY = center.Y() + radius;
+	
+	for(auto it = SweepStart(minX); it != bounds.end() && it->minX <= maxX; ++it)
+	{
+		if(it->maxX < minX || it->maxY < minY || it->minY > maxY)
+			continue;
+		
+		const Mask &mask = it->body->GetMask();
+		Point offset = center - it->body->Position();
+		if(offset.Length() <= radius || mask.WithinRange(offset, it->body->Facing(), radius))
+			result.push_back(it->body);
+	}
+}
+
+
+
+// Get the first object in the sweep whose bounding box could extend past the
+// given x coordinate. No object is wider than maxWidth, so any object that
+// begins farther to the left than that cannot reach it.
+vector<CollisionSet::Bounds>::const_iterator CollisionSet::SweepStart(double minX) const
+{
+	return lower_bound(bounds.begin(), bounds.end(), minX - maxWidth,
+		[](const Bounds &entry, double x)
+		{
+			return entry.minX < x;
+		});
 }
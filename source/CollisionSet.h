@@ -22,14 +22,27 @@ class Body;
 
 
 
-// A CollisionSet allows efficient collision detection by splitting space up
-// into a grid and keeping track of which objects are in each grid cell. A check
-// for collisions can then only examine objects in certain cells.
+// A CollisionSet allows efficient collision detection by narrowing down which
+// objects a given line or circle might touch. It can either split space up into
+// a grid and keep track of which objects are in each grid cell, so a check for
+// collisions only examines objects in certain cells, or it can sort the objects
+// by their leftmost extent, so a check only examines the objects whose bounding
+// boxes overlap that span ("sort and sweep"). A grid is fastest for objects
+// that are evenly spread out in a region that matches the grid size, while the
+// sweep scales with the number of objects no matter how far apart they are or
+// how big they are.
 class CollisionSet {
 public:
-	// Initialize a collision set. The cell size and cell count should both be
-	// powers of two; otherwise, they are rounded down to a power of two.
+	enum Structure {GRID, SWEEP};
+	
+	
+public:
+	// Initialize a grid collision set. The cell size and cell count should both
+	// be powers of two; otherwise, they are rounded down to a power of two.
 	CollisionSet(unsigned cellSize, unsigned cellCount);
+	// Initialize a collision set with the given structure. A grid created this
+	// way has 32 x 32 cells, each 256 pixels across.
+	explicit CollisionSet(Structure structure);
 	
 	// Clear all objects in the set. Specify which engine step we are on, so we
 	// know what animation frame each object is on.
@@ -47,23 +60,60 @@ public:
 	Body *Line(const Point &from, const Point &to, double *closestHit = nullptr,
 		const Government *pGov = nullptr, const Body *target = nullptr) const;
 	
-	// Get all objects within the given range of the given point.
-	const std::vector<Body *> &Circle(const Point &center, double radius) const;
+	// Get all objects within the given range of the given point. The objects
+	// are stored in the given vector, replacing anything that was in it. None
+	// of the queries modify the set, so they may be run from multiple threads
+	// at once (once Finish() has been called).
+	void Circle(const Point &center, double radius, std::vector<Body *> &result) const;
 	
 	
 private:
 	class Entry {
 	public:
 		Entry() = default;
-		Entry(Body *body, int x, int y) : body(body), x(x), y(y) {}
+		Entry(Body *body, int x, int y, int minX, int minY)
+			: body(body), x(x), y(y), minX(minX), minY(minY) {}
 		
 		Body *body;
 		int x;
 		int y;
+		// The first grid cell this object occupies. A query that covers more
+		// than one of the object's cells only examines it in the first one.
+		int minX;
+		int minY;
+	};
+	
+	// For a sweep, each object is stored along with its bounding box.
+	class Bounds {
+	public:
+		Bounds() = default;
+		Bounds(Body *body, double minX, double minY, double maxX, double maxY)
+			: body(body), minX(minX), minY(minY), maxX(maxX), maxY(maxY) {}
+		
+		Body *body;
+		double minX;
+		double minY;
+		double maxX;
+		double maxY;
 	};
 	
 	
 private:
+	// Queries, for each type of structure.
+	Body *GridLine(const Point &from, const Point &to, double *closestHit,
+		const Government *pGov, const Body *target) const;
+	Body *SweepLine(const Point &from, const Point &to, double *closestHit,
+		const Government *pGov, const Body *target) const;
+	void GridCircle(const Point &center, double radius, std::vector<Body *> &result) const;
+	void SweepCircle(const Point &center, double radius, std::vector<Body *> &result) const;
+	// Get the first object in the sweep whose bounding box could extend past
+	// the given x coordinate.
+	std::vector<Bounds>::const_iterator SweepStart(double minX) const;
+	
+	
+private:
+	Structure structure;
+	
 	// The size of individual cells of the grid.
 	unsigned CELL_SIZE;
 	unsigned SHIFT;
@@ -82,8 +132,10 @@ private:
 	// After Finish(), counts[index] is where a certain bin begins.
 	std::vector<unsigned> counts;
 	
-	// Vector for returning the result of a circle query.
-	mutable std::vector<Body *> result;
+	// For a sweep, the objects sorted by minimum x, and the largest width of
+	// any of them (which bounds how far back a query must look).
+	std::vector<Bounds> bounds;
+	double maxWidth = 0.;
 };
 
 
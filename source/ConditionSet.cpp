@@ -12,6 +12,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "ConditionSet.h"
 
+#include "ConditionsStore.h"
 #include "DataNode.h"
 #include "DataWriter.h"
 #include "Random.h"
@@ -19,6 +20,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <map>
 
 using namespace std;
 
@@ -49,6 +51,24 @@ namespace {
 		auto it = opMap.find(op);
 		return (it != opMap.end() ? it->second : nullptr);
 	}
+	
+	// Slot value for a token that is a constant rather than a condition.
+	const int CONSTANT = -1;
+	
+	// Special case: if the string of the token is "random," that means to
+	// generate a random number from 0 to 99 each time it is queried.
+	int RandomSlot()
+	{
+		static const int slot = ConditionsStore::Slot("random");
+		return slot;
+	}
+	
+	// Get a new condition set ID.
+	int NewId()
+	{
+		static int nextId = 0;
+		return ++nextId;
+	}
 }
 
 
@@ -67,6 +87,7 @@ void ConditionSet::Load(const DataNode &node)
 	isOr = (node.Token(0) == "or");
 	for(const DataNode &child : node)
 		Add(child);
+	id = NewId();
 }
 
 
@@ -140,6 +161,7 @@ void ConditionSet::Add(const DataNode &node)
 	}
 	else
 		node.PrintTrace("Unrecognized condition expression:");
+	id = NewId();
 }
 
 
@@ -163,6 +185,7 @@ bool ConditionSet::Add(const string &firstToken, const string &secondToken)
 	else
 		return false;
 	
+	id = NewId();
 	return true;
 }
 
@@ -177,6 +200,7 @@ bool ConditionSet::Add(const string &name, const string &op, int64_t value)
 		return false;
 	
 	expressions.emplace_back(name, op, value);
+	id = NewId();
 	return true;
 }
 
@@ -190,20 +214,48 @@ bool ConditionSet::Add(const string &name, const string &op, const string &strVa
 	if(!fun)
 		return false;
 	
-	expressions.emplace_back(name, op, 0);
-	expressions.back().strValue = strValue;
+	expressions.emplace_back(name, op, 0, strValue);
+	id = NewId();
+	return true;
+}
+
+
+
+// Get a number identifying the contents of this set.
+int ConditionSet::Id() const
+{
+	return id;
+}
+
+
+
+// Get the slots of all the conditions that Test() reads. If the result of
+// Test() is random, this returns false.
+bool ConditionSet::GetInputs(vector<int> &slots) const
+{
+	for(const Expression &expression : expressions)
+	{
+		if(expression.slot == RandomSlot() || expression.valueSlot == RandomSlot())
+			return false;
+		slots.push_back(expression.slot);
+		if(expression.valueSlot != CONSTANT)
+			slots.push_back(expression.valueSlot);
+	}
+	for(const ConditionSet &child : children)
+		if(!child.GetInputs(slots))
+			return false;
 	return true;
 }
 
 
 
 // Check if the given condition values satisfy this set of conditions.
-bool ConditionSet::Test(const map<string, int64_t> &conditions) const
+bool ConditionSet::Test(const ConditionsStore &conditions) const
 {
 	for(const Expression &expression : expressions)
 	{
-		auto firstValue = TokenValue(0, expression.name, conditions);
-		auto secondValue = TokenValue(expression.value, expression.strValue, conditions);
+		auto firstValue = TokenValue(0, expression.slot, conditions);
+		auto secondValue = TokenValue(expression.value, expression.valueSlot, conditions);
 		bool result = expression.fun(firstValue, secondValue);
 		// If this is a set of "and" conditions, bail out as soon as one of them
 		// returns false. If it is an "or", bail out if anything returns true.
@@ -225,12 +277,12 @@ bool ConditionSet::Test(const map<string, int64_t> &conditions) const
 
 
 // Modify the given set of conditions.
-void ConditionSet::Apply(map<string, int64_t> &conditions) const
+void ConditionSet::Apply(ConditionsStore &conditions) const
 {
 	for(const Expression &expression : expressions)
 	{
-		auto &c = conditions[expression.name];
-		auto value = TokenValue(expression.value, expression.strValue, conditions);
+		auto &c = conditions.Value(expression.slot);
+		auto value = TokenValue(expression.value, expression.valueSlot, conditions);
 		c = expression.fun(c, value);
 	}
 	// Note: "and" and "or" make no sense for "Apply()," so a condition set that
@@ -242,27 +294,23 @@ void ConditionSet::Apply(map<string, int64_t> &conditions) const
 
 
 
-// Check if the passed token is numeric or a string which has to be replaced, and return its value
-int64_t ConditionSet::TokenValue(int64_t numValue, const string &strValue, const map<string, int64_t> &conditions) const
+// Check if the passed token is numeric or a condition which has to be
+// replaced, and return its value.
+int64_t ConditionSet::TokenValue(int64_t numValue, int slot, const ConditionsStore &conditions) const
 {
-	auto value = numValue;
-	// Special case: if the string of the token is "random," that means to
-	// generate a random number from 0 to 99 each time it is queried.
-	if(strValue == "random")
-		value = Random::Int(100);
-	else
-	{
-		auto it = conditions.find(strValue);
-		if(it != conditions.end())
-			value = it->second;
-	}
-	return value;
+	if(slot == CONSTANT)
+		return numValue;
+	if(slot == RandomSlot())
+		return Random::Int(100);
+	// A condition that is not set has a value of zero.
+	return conditions.Get(slot);
 }
 
 
 
 // Constructor for an expression.
-ConditionSet::Expression::Expression(const string &name, const string &op, int64_t value)
-	: name(name), op(op), fun(Op(op)), value(value)
+ConditionSet::Expression::Expression(const string &name, const string &op, int64_t value, const string &strValue)
+	: name(name), slot(ConditionsStore::Slot(name)), op(op), fun(Op(op)), value(value),
+	strValue(strValue), valueSlot(strValue.empty() ? CONSTANT : ConditionsStore::Slot(strValue))
 {
 }
@@ -13,10 +13,11 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef CONDITION_SET_H_
 #define CONDITION_SET_H_
 
-#include <map>
+#include <cstdint>
 #include <string>
 #include <vector>
 
+class ConditionsStore;
 class DataNode;
 class DataWriter;
 
@@ -25,7 +26,8 @@ class DataWriter;
 // A condition set is a collection of operations on the player's set of named
 // "conditions". This includes "test" operations that just check the values of
 // those conditions, and other operations that can be "applied" to change the
-// values.
+// values. Each condition name is converted to its ConditionsStore slot when the
+// set is loaded, so testing or applying it needs no string lookups.
 class ConditionSet {
 public:
 	ConditionSet() = default;
@@ -46,15 +48,23 @@ public:
 	bool Add(const std::string &name, const std::string &op, int64_t value);
 	bool Add(const std::string &name, const std::string &op, const std::string &strValue);
 	
+	// Get a number identifying the contents of this set. Copies of a set share
+	// its ID, and the ID changes whenever the set is modified.
+	int Id() const;
+	// Get the slots of all the conditions that Test() reads. If the result of
+	// Test() is random, this returns false.
+	bool GetInputs(std::vector<int> &slots) const;
+	
 	// Check if the given condition values satisfy this set of conditions.
-	bool Test(const std::map<std::string, int64_t> &conditions) const;
+	bool Test(const ConditionsStore &conditions) const;
 	// Modify the given set of conditions.
-	void Apply(std::map<std::string, int64_t> &conditions) const;
+	void Apply(ConditionsStore &conditions) const;
 	
 	
 private:
-	// Check if the passed token is numeric or a string which has to be replaced, and return its value
-	int64_t TokenValue(int64_t numValue, const std::string &strValue, const std::map<std::string, int64_t> &conditions) const;
+	// Check if the passed token is numeric or a condition which has to be
+	// replaced, and return its value.
+	int64_t TokenValue(int64_t numValue, int slot, const ConditionsStore &conditions) const;
 	
 	
 private:
@@ -62,10 +72,11 @@ private:
 	// testing what value it has, or modifying it in some way.
 	class Expression {
 	public:
-		Expression(const std::string &name, const std::string &op, int64_t value);
+		Expression(const std::string &name, const std::string &op, int64_t value, const std::string &strValue = "");
 		
 		// This is the name of the condition that this entry operates on.
 		std::string name;
+		int slot;
 		// This needs to be saved for saving conditions.
 		std::string op;
 		// Pointer to a binary function that defines what operation should be
@@ -73,8 +84,10 @@ private:
 		int64_t (*fun)(int64_t, int64_t);
 		// Constant value specified in the expression.
 		int64_t value;
-		// Allow for dynamic values.
+		// Allow for dynamic values. If the value is a condition name, this is its
+		// slot; otherwise it is -1.
 		std::string strValue;
+		int valueSlot;
 	};
 	
 	
@@ -83,6 +96,7 @@ private:
 	// either an "and" grouping (meaning every condition must be true to satisfy
 	// it) or an "or" grouping where only one condition needs to be true.
 	bool isOr = false;
+	int id = 0;
 	// Conditions that this set tests or applies.
 	std::vector<Expression> expressions;
 	// Nested sets of conditions to be tested.
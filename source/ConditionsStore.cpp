@@ -0,0 +1,246 @@
+/* ConditionsStore.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "ConditionsStore.h"
+
+#include "ConditionSet.h"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+namespace {
+	// The slot assigned to each condition name, and the name in each slot.
+	map<string, int> slots;
+	vector<const string *> names;
+	
+	// States of a cached condition set test.
+	const char UNKNOWN = 0;
+	const char STALE = 1;
+	const char FAILED = 2;
+	const char PASSED = 3;
+}
+
+
+
+ConditionsStore::ConditionsStore(const ConditionsStore &other)
+{
+	*this = other;
+}
+
+
+
+// The copied pointers would point to the other store's values, so they must
+// be recreated. Cached results are not copied.
+ConditionsStore &ConditionsStore::operator=(const ConditionsStore &other)
+{
+	if(this == &other)
+		return *this;
+	
+	results.clear();
+	dependents.clear();
+	checked.clear();
+	touched.clear();
+	isTouched.clear();
+	
+	values = other.values;
+	bySlot.assign(other.bySlot.size(), nullptr);
+	for(auto &it : values)
+	{
+		int slot = Slot(it.first);
+		if(static_cast<size_t>(slot) >= bySlot.size())
+			bySlot.resize(slot + 1, nullptr);
+		bySlot[slot] = &it.second;
+	}
+	return *this;
+}
+
+
+
+// Get the slot for the given condition name, assigning it a new one if it has
+// never been used before. Slots are shared by all stores.
+int ConditionsStore::Slot(const string &name)
+{
+	auto it = slots.emplace(name, static_cast<int>(names.size())).first;
+	if(static_cast<size_t>(it->second) == names.size())
+		names.push_back(&it->first);
+	return it->second;
+}
+
+
+
+// Get the value of the condition in the given slot. If it is not set, its
+// value is zero.
+int64_t ConditionsStore::Get(int slot) const
+{
+	if(static_cast<size_t>(slot) >= bySlot.size() || !bySlot[slot])
+		return 0;
+	return *bySlot[slot];
+}
+
+
+
+// Get a reference to the value of the condition in the given slot, adding it
+// to the store (with a value of zero) if it is not set.
+int64_t &ConditionsStore::Value(int slot)
+{
+	if(static_cast<size_t>(slot) >= bySlot.size())
+		bySlot.resize(slot + 1, nullptr);
+	if(!bySlot[slot])
+		bySlot[slot] = &values[*names[slot]];
+	Touch(slot);
+	return *bySlot[slot];
+}
+
+
+
+int64_t &ConditionsStore::operator[](const string &name)
+{
+	return Value(Slot(name));
+}
+
+
+
+bool ConditionsStore::empty() const
+{
+	return values.empty();
+}
+
+
+
+ConditionsStore::const_iterator ConditionsStore::begin() const
+{
+	return values.begin();
+}
+
+
+
+ConditionsStore::const_iterator ConditionsStore::end() const
+{
+	return values.end();
+}
+
+
+
+ConditionsStore::const_iterator ConditionsStore::find(const string &name) const
+{
+	return values.find(name);
+}
+
+
+
+ConditionsStore::const_iterator ConditionsStore::lower_bound(const string &name) const
+{
+	return values.lower_bound(name);
+}
+
+
+
+void ConditionsStore::erase(const string &name)
+{
+	auto it = values.find(name);
+	if(it != values.end())
+		erase(it, next(it));
+}
+
+
+
+void ConditionsStore::erase(const_iterator first, const_iterator last)
+{
+	for(const_iterator it = first; it != last; ++it)
+	{
+		int slot = Slot(it->first);
+		bySlot[slot] = nullptr;
+		Touch(slot);
+	}
+	values.erase(first, last);
+}
+
+
+
+// Test the given condition set, reusing the cached result if none of the
+// conditions it reads have changed since it was last tested.
+bool ConditionsStore::Test(const ConditionSet &conditions) const
+{
+	int id = conditions.Id();
+	if(!id)
+		return conditions.Test(*this);
+	
+	Invalidate();
+	if(static_cast<size_t>(id) >= results.size())
+		results.resize(id + 1, UNKNOWN);
+	char &result = results[id];
+	if(result == FAILED || result == PASSED)
+		return (result == PASSED);
+	
+	bool value = conditions.Test(*this);
+	if(result == UNKNOWN)
+	{
+		// The first time a set is tested, find out what conditions it depends
+		// on. If it uses random numbers, its result can never be cached.
+		vector<int> slots;
+		if(!conditions.GetInputs(slots))
+			return value;
+		
+		sort(slots.begin(), slots.end());
+		slots.erase(unique(slots.begin(), slots.end()), slots.end());
+		for(int slot : slots)
+		{
+			if(static_cast<size_t>(slot) >= dependents.size())
+			{
+				dependents.resize(slot + 1);
+				checked.resize(slot + 1, 0);
+				isTouched.resize(slot + 1, false);
+			}
+			if(dependents[slot].empty())
+				checked[slot] = Get(slot);
+			dependents[slot].push_back(id);
+		}
+	}
+	result = (value ? PASSED : FAILED);
+	return value;
+}
+
+
+
+// Note that the value in the given slot may be about to change. Only the
+// slots that some cached result depends on need to be tracked.
+void ConditionsStore::Touch(int slot)
+{
+	if(static_cast<size_t>(slot) < dependents.size() && !dependents[slot].empty() && !isTouched[slot])
+	{
+		isTouched[slot] = true;
+		touched.push_back(slot);
+	}
+}
+
+
+
+// Discard the cached results that depend on conditions that have changed.
+// Conditions are often set to the value they already had, so the values are
+// compared rather than assuming that every touched condition has changed.
+void ConditionsStore::Invalidate() const
+{
+	for(int slot : touched)
+	{
+		isTouched[slot] = false;
+		int64_t value = Get(slot);
+		if(value == checked[slot])
+			continue;
+		
+		checked[slot] = value;
+		for(int id : dependents[slot])
+			results[id] = STALE;
+	}
+	touched.clear();
+}
@@ -0,0 +1,100 @@
+/* ConditionsStore.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef CONDITIONS_STORE_H_
+#define CONDITIONS_STORE_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class ConditionSet;
+
+
+
+// Class holding the values of the player's named "conditions." They are kept
+// in a map, so that they can be listed by prefix and saved in order. But, each
+// condition name is also given a permanent numeric "slot," and the store keeps
+// a pointer to each condition's value indexed by its slot. Condition sets look
+// up the slots of the names they use when they are loaded, so that testing or
+// applying them does not involve any string comparisons.
+// The store can also remember the results of testing condition sets. A cached
+// result is only discarded once one of the conditions that set reads changes.
+class ConditionsStore {
+public:
+	typedef std::map<std::string, int64_t>::const_iterator const_iterator;
+	
+	
+public:
+	ConditionsStore() = default;
+	ConditionsStore(const ConditionsStore &other);
+	ConditionsStore &operator=(const ConditionsStore &other);
+	ConditionsStore(ConditionsStore &&other) = default;
+	ConditionsStore &operator=(ConditionsStore &&other) = default;
+	
+	// Get the slot for the given condition name, assigning it a new one if it
+	// has never been used before. Slots are shared by all stores.
+	static int Slot(const std::string &name);
+	
+	// Get the value of the condition in the given slot. If it is not set, its
+	// value is zero.
+	int64_t Get(int slot) const;
+	// Get a reference to the value of the condition in the given slot, adding
+	// it to the store (with a value of zero) if it is not set.
+	int64_t &Value(int slot);
+	
+	// Access conditions by name. Conditions can only be modified through this
+	// or Value(), not through the iterators, so that the slots stay up to date.
+	int64_t &operator[](const std::string &name);
+	bool empty() const;
+	const_iterator begin() const;
+	const_iterator end() const;
+	const_iterator find(const std::string &name) const;
+	const_iterator lower_bound(const std::string &name) const;
+	void erase(const std::string &name);
+	void erase(const_iterator first, const_iterator last);
+	
+	// Test the given condition set. Unless its result is random, the result is
+	// cached, and the set is only tested again after a condition it reads has
+	// changed. So, it is cheap to test the same sets over and over.
+	bool Test(const ConditionSet &conditions) const;
+	
+	
+private:
+	// Note that the value in the given slot may be about to change.
+	void Touch(int slot);
+	// Discard the cached results that depend on conditions that have changed.
+	void Invalidate() const;
+	
+	
+private:
+	std::map<std::string, int64_t> values;
+	// Pointers to the entries in the map, indexed by slot. Map entries never
+	// move, so these stay valid until the entry is erased.
+	std::vector<int64_t *> bySlot;
+	
+	// Cached test results, indexed by condition set ID. A set that has never
+	// been tested is UNKNOWN; one whose result is out of date is STALE.
+	mutable std::vector<char> results;
+	// For each slot, the IDs of the sets whose results depend on it, and the
+	// value the condition had when those results were last checked.
+	mutable std::vector<std::vector<int>> dependents;
+	mutable std::vector<int64_t> checked;
+	// Slots with dependents that may have been modified since the last check.
+	mutable std::vector<int> touched;
+	mutable std::vector<char> isTouched;
+};
+
+
+
+#endif
@@ -77,7 +77,7 @@ void DataFile::Load(istream &in)
 
 
 // Get an iterator to the start of the list of nodes in this file.
-list<DataNode>::const_iterator DataFile::begin() const
+vector<DataNode>::const_iterator DataFile::begin() const
 {
 	return root.begin();
 }
@@ -85,7 +85,7 @@ list<DataNode>::const_iterator DataFile::begin() const
 
 
 // Get an iterator to the end of the list of nodes in this file.
-list<DataNode>::const_iterator DataFile::end() const
+vector<DataNode>::const_iterator DataFile::end() const
 {
 	return root.end();
 }
@@ -102,6 +102,9 @@ void DataFile::Load(const char *it, const char *end)
 	vector<int> whiteStack(1, -1);
 	bool fileIsSpaces = false;
 	bool warned = false;
+	// Find all the tokens in a line before adding any of them to the node, so
+	// that its token list can be allocated at exactly the right size.
+	vector<pair<const char *, const char *>> tokens;
 	
 	for( ; it != end; ++it)
 	{
@@ -148,8 +151,9 @@ void DataFile::Load(const char *it, const char *end)
 			stack.pop_back();
 		}
 		
-		// Add this node as a child of the proper node.
-		list<DataNode> &children = stack.back()->children;
+		// Add this node as a child of the proper node. This may move any nodes
+		// that were already children of it, but none of them are in the stack.
+		vector<DataNode> &children = stack.back()->children;
 		children.emplace_back(stack.back());
 		DataNode &node = children.back();
 		
@@ -158,6 +162,8 @@ void DataFile::Load(const char *it, const char *end)
 		whiteStack.push_back(white);
 		
 		// Tokenize the line. Skip comments and empty lines.
+		tokens.clear();
+		bool missingQuote = false;
 		while(*it != '\n')
 		{
 			// Check if this token begins with a quotation mark. If so, it will
@@ -172,16 +178,8 @@ void DataFile::Load(const char *it, const char *end)
 			while(*it != '\n' && (isQuoted ? (*it != endQuote) : (*it > ' ')))
 				++it;
 			
-			// It ought to be legal to construct a string from an empty iterator
-			// range, but it appears that some libraries do not handle that case
-			// correctly. So:
-			if(start == it)
-				node.tokens.emplace_back();
-			else
-				node.tokens.emplace_back(start, it);
-			// This is not a fatal error, but it may indicate a format mistake:
-			if(isQuoted && *it == '\n')
-				node.PrintTrace("Closing quotation mark is missing:");
+			tokens.emplace_back(start, it);
+			missingQuote |= (isQuoted && *it == '\n');
 			
 			if(*it != '\n')
 			{
@@ -200,5 +198,20 @@ void DataFile::Load(const char *it, const char *end)
 				}
 			}
 		}
+		
+		node.tokens.reserve(tokens.size());
+		for(const pair<const char *, const char *> &token : tokens)
+		{
+			// It ought to be legal to construct a string from an empty iterator
+			// range, but it appears that some libraries do not handle that case
+			// correctly. So:
+			if(token.first == token.second)
+				node.tokens.emplace_back();
+			else
+				node.tokens.emplace_back(token.first, token.second);
+		}
+		// This is not a fatal error, but it may indicate a format mistake:
+		if(missingQuote)
+			node.PrintTrace("Closing quotation mark is missing:");
 	}
 }
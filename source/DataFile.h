@@ -16,8 +16,8 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "DataNode.h"
 
 #include <istream>
-#include <list>
 #include <string>
+#include <vector>
 
 
 
@@ -38,8 +38,8 @@ public:
 	void Load(std::istream &in);
 	
 	// Functions for iterating through all DataNodes in this file.
-	std::list<DataNode>::const_iterator begin() const;
-	std::list<DataNode>::const_iterator end() const;
+	std::vector<DataNode>::const_iterator begin() const;
+	std::vector<DataNode>::const_iterator end() const;
 	
 	
 private:
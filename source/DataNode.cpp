@@ -26,10 +26,6 @@ using namespace std;
 DataNode::DataNode(const DataNode *parent)
 	: parent(parent)
 {
-	// To avoid a lot of memory reallocation, have every node start out with
-	// capacity for four tokens. This makes file loading slightly faster, at the
-	// cost of DataFiles taking up a bit more memory.
-	tokens.reserve(4);
 }
 
 
@@ -43,6 +39,17 @@ DataNode::DataNode(const DataNode &other)
 
 
 
+// Move constructor. The children keep their addresses, so only their parent
+// pointers need to be updated, not those of any nodes below them.
+DataNode::DataNode(DataNode &&other) noexcept
+	: children(move(other.children)), tokens(move(other.tokens)), parent(other.parent)
+{
+	for(DataNode &child : children)
+		child.parent = this;
+}
+
+
+
 // Assignment operator.
 DataNode &DataNode::operator=(const DataNode &other)
 {
@@ -182,7 +189,7 @@ bool DataNode::HasChildren() const
 
 
 // Iterator to the beginning of the list of children.
-list<DataNode>::const_iterator DataNode::begin() const
+vector<DataNode>::const_iterator DataNode::begin() const
 {
 	return children.begin();
 }
@@ -190,7 +197,7 @@ list<DataNode>::const_iterator DataNode::begin() const
 
 
 // Iterator to the end of the list of children.
-list<DataNode>::const_iterator DataNode::end() const
+vector<DataNode>::const_iterator DataNode::end() const
 {
 	return children.end();
 }
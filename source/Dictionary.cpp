@@ -13,8 +13,8 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Dictionary.h"
 
 #include <cstring>
+#include <map>
 #include <mutex>
-#include <set>
 #include <string>
 
 using namespace std;
@@ -45,27 +45,44 @@ namespace {
 	}
 	
 	// String interning: return a pointer to a character string that matches the
-	// given string but has static storage duration.
-	const char *Intern(const char *key)
+	// given string but has static storage duration, and a unique index for it.
+	pair<const char *, size_t> Intern(const char *key)
 	{
-		static set<string> interned;
+		static map<string, size_t> interned;
 		static mutex m;
 		
 		// Just in case this function is accessed from multiple threads:
 		lock_guard<mutex> lock(m);
-		return interned.insert(key).first->c_str();
+		auto it = interned.emplace(key, interned.size()).first;
+		return make_pair(it->first.c_str(), it->second);
 	}
 }
 
 
 
+Dictionary::Key::Key(const char *name)
+	: index(Intern(name).second)
+{
+}
+
+
+
 double &Dictionary::operator[](const char *key)
 {
 	pair<size_t, bool> pos = Search(key, *this);
 	if(pos.second)
 		return data()[pos.first].second;
 	
-	return insert(begin() + pos.first, make_pair(Intern(key), 0.))->second;
+	// Every entry after the insertion point is about to move down by one.
+	pair<const char *, size_t> interned = Intern(key);
+	for(uint16_t &position : positions)
+		if(position > pos.first)
+			++position;
+	if(positions.size() <= interned.second)
+		positions.resize(interned.second + 1);
+	positions[interned.second] = pos.first + 1;
+	
+	return insert(begin() + pos.first, make_pair(interned.first, 0.))->second;
 }
 
 
@@ -89,3 +106,13 @@ double Dictionary::Get(const string &key) const
 {
 	return Get(key.c_str());
 }
+
+
+
+double Dictionary::Get(const Key &key) const
+{
+	if(key.index >= positions.size() || !positions[key.index])
+		return 0.;
+	
+	return data()[positions[key.index] - 1].second;
+}
@@ -13,6 +13,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef DICTIONARY_H_
 #define DICTIONARY_H_
 
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
@@ -24,6 +25,21 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 // compared to an STL map. That makes it suitable for ship attributes, which are
 // changed much less frequently than they are queried.
 class Dictionary : private std::vector<std::pair<const char *, double>> {
+public:
+	// A key that has already been looked up, so that its value can be found in
+	// any dictionary without comparing strings. Creating a key is slow, so it
+	// should be done once (e.g. as a static constant) and then reused.
+	class Key {
+	public:
+		explicit Key(const char *name);
+		
+	private:
+		size_t index;
+		
+		friend class Dictionary;
+	};
+	
+	
 public:
 	// Access a key for modifying it:
 	double &operator[](const char *key);
@@ -31,11 +47,18 @@ public:
 	// Get the value of a key, or 0 if it does not exist:
 	double Get(const char *key) const;
 	double Get(const std::string &key) const;
+	double Get(const Key &key) const;
 	
 	// Expose certain functions from the underlying vector:
 	using std::vector<std::pair<const char *, double>>::empty;
 	using std::vector<std::pair<const char *, double>>::begin;
 	using std::vector<std::pair<const char *, double>>::end;
+	
+	
+private:
+	// For each key that has ever been created, one more than the position of
+	// its entry in this dictionary, or 0 if it has no entry here.
+	std::vector<uint16_t> positions;
 };
 
 
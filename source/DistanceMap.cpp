@@ -12,14 +12,34 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "DistanceMap.h"
 
+#include "GameData.h"
 #include "Planet.h"
 #include "PlayerInfo.h"
 #include "Ship.h"
 #include "StellarObject.h"
 #include "System.h"
 
+#include <mutex>
+
 using namespace std;
 
+namespace {
+	// The index of each system in the shared routes. If this is null, the
+	// routes must be recalculated. Maps should only be created from the main
+	// thread, but just to be sure, the shared routes are protected by a mutex.
+	mutex routesMutex;
+	shared_ptr<const unordered_map<const System *, int>> routesIndex;
+}
+
+
+
+// Discard the shared routes.
+void DistanceMap::ClearRoutes()
+{
+	lock_guard<mutex> lock(routesMutex);
+	routesIndex.reset();
+}
+
 
 
 // Find paths to the given system. If the given maximum count is above zero,
@@ -28,7 +48,11 @@ using namespace std;
 DistanceMap::DistanceMap(const System *center, int maxCount, int maxDistance)
 	: center(center), maxCount(maxCount), maxDistance(maxDistance), useWormholes(false)
 {
-	Init();
+	// With no limits, this map is the same as any other map from this center.
+	if(center && maxCount < 0 && maxDistance < 0)
+		UseSharedRoutes();
+	else
+		Init();
 }
 
 
@@ -76,7 +100,7 @@ DistanceMap::DistanceMap(const Ship &ship, const System *destination)
 // Find out if the given system is reachable.
 bool DistanceMap::HasRoute(const System *system) const
 {
-	return route.count(system);
+	return Find(system);
 }
 
 
@@ -84,8 +108,8 @@ bool DistanceMap::HasRoute(const System *system) const
 // Find out how many days away the given system is.
 int DistanceMap::Days(const System *system) const
 {
-	auto it = route.find(system);
-	return (it == route.end() ? -1 : it->second.days);
+	const Edge *edge = Find(system);
+	return (edge ? edge->days : -1);
 }
 
 
@@ -93,8 +117,8 @@ int DistanceMap::Days(const System *system) const
 // Starting in the given system, what is the next system along the route?
 const System *DistanceMap::Route(const System *system) const
 {
-	auto it = route.find(system);
-	return (it == route.end() ? nullptr : it->second.next);
+	const Edge *edge = Find(system);
+	return (edge ? edge->next : nullptr);
 }
 	
 	
@@ -103,8 +127,15 @@ const System *DistanceMap::Route(const System *system) const
 set<const System *> DistanceMap::Systems() const
 {
 	set<const System *> systems;
-	for(const auto &it : route)
-		systems.insert(it.first);
+	if(shared)
+	{
+		for(const auto &it : *index)
+			if((*shared)[it.second].days >= 0)
+				systems.insert(it.first);
+	}
+	else
+		for(const auto &it : route)
+			systems.insert(it.first);
 	return systems;
 }
 
@@ -120,11 +151,11 @@ const System *DistanceMap::End() const
 
 int DistanceMap::RequiredFuel(const System *system1, const System *system2) const
 {
-	auto it1 = route.find(system1);
-	auto it2 = route.find(system2);
-	if(it1 == route.end() || it2 == route.end())
+	const Edge *edge1 = Find(system1);
+	const Edge *edge2 = Find(system2);
+	if(!edge1 || !edge2)
 		return -1;
-	return abs(it1->second.fuel - it2->second.fuel);
+	return abs(edge1->fuel - edge2->fuel);
 }
 
 
@@ -152,6 +183,63 @@ bool DistanceMap::Edge::operator<(const Edge &other) const
 
 
 
+// Use the shared routes from this map's center, calculating them if this is
+// the first time that the center has been used since the links changed.
+void DistanceMap::UseSharedRoutes()
+{
+	// The routes from each center that has been used.
+	static map<const System *, shared_ptr<const vector<Edge>>> routes;
+	
+	lock_guard<mutex> lock(routesMutex);
+	if(!routesIndex)
+	{
+		routes.clear();
+		unordered_map<const System *, int> systems;
+		for(const auto &it : GameData::Systems())
+			systems.emplace(&it.second, static_cast<int>(systems.size()));
+		routesIndex = make_shared<const unordered_map<const System *, int>>(move(systems));
+	}
+	index = routesIndex;
+	
+	shared_ptr<const vector<Edge>> &found = routes[center];
+	if(!found)
+	{
+		// Find the routes the normal way, then store them in the array.
+		Init();
+		Edge unreachable;
+		unreachable.days = -1;
+		vector<Edge> row(index->size(), unreachable);
+		for(const auto &it : route)
+		{
+			auto iit = index->find(it.first);
+			if(iit != index->end())
+				row[iit->second] = it.second;
+		}
+		route.clear();
+		found = make_shared<const vector<Edge>>(move(row));
+	}
+	shared = found;
+}
+
+
+
+// Get the route to the given system, or null if it cannot be reached.
+const DistanceMap::Edge *DistanceMap::Find(const System *system) const
+{
+	if(shared)
+	{
+		auto it = index->find(system);
+		if(it == index->end())
+			return nullptr;
+		const Edge &edge = (*shared)[it->second];
+		return (edge.days < 0 ? nullptr : &edge);
+	}
+	auto it = route.find(system);
+	return (it == route.end() ? nullptr : &it->second);
+}
+
+
+
 // Depending on the capabilities of the given ship, use hyperspace paths,
 // jump drive paths, or both to find the shortest route. Bail out if the
 // source system or the maximum count is reached.
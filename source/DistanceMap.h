@@ -14,9 +14,12 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #define DISTANCE_MAP_H_
 
 #include <map>
+#include <memory>
 #include <queue>
 #include <set>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 class PlayerInfo;
 class Ship;
@@ -29,7 +32,16 @@ class System;
 // "links" between systems. Ships with jump drives can make use of those links,
 // but can also travel to any of a system's "neighbors." A distance map can also
 // be used to calculate the shortest route between two systems.
+// A map with no limits and no player or ship only depends on the hyperspace
+// links, so the routes from each center are only calculated once, and then
+// shared by every such map.
 class DistanceMap {
+public:
+	// Discard the shared routes. This must be done any time that the
+	// hyperspace links change.
+	static void ClearRoutes();
+	
+	
 public:
 	// Find paths to the given system. The optional arguments put a limit on how
 	// many systems will be returned and how far away they are allowed to be.
@@ -79,6 +91,11 @@ private:
 	
 	
 private:
+	// Use the shared routes from this map's center, calculating them if this is
+	// the first time that the center has been used since the links changed.
+	void UseSharedRoutes();
+	// Get the route to the given system, or null if it cannot be reached.
+	const Edge *Find(const System *system) const;
 	// Depending on the capabilities of the given ship, use hyperspace paths,
 	// jump drive paths, or both to find the shortest route. Bail out if the
 	// source system or the maximum count is reached.
@@ -97,6 +114,11 @@ private:
 	
 private:
 	std::map<const System *, Edge> route;
+	// If this map uses the shared routes, they are stored in an array instead,
+	// along with the index of each system in that array. Systems that cannot
+	// be reached have negative days.
+	std::shared_ptr<const std::unordered_map<const System *, int>> index;
+	std::shared_ptr<const std::vector<Edge>> shared;
 	
 	// Variables only used during construction:
 	std::priority_queue<Edge> edges;
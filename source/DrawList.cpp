@@ -19,6 +19,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "SpriteSet.h"
 #include "SpriteShader.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace std;
@@ -116,8 +117,7 @@ void DrawList::Draw() const
 	SpriteShader::Bind();
 	
 	bool withBlur = Preferences::Has("Render motion blur");
-	for(const SpriteShader::Item &item : items)
-		SpriteShader::Add(item, withBlur);
+	SpriteShader::Add(items, withBlur);
 	
 	SpriteShader::Unbind();
 }
@@ -151,7 +151,10 @@ void DrawList::Push(const Body &body, Point pos, Point blur, double cloak, doubl
 {
 	SpriteShader::Item item;
 	
-	item.texture = body.GetSprite()->Texture(isHighDPI);
+	const Sprite::Layout *layout;
+	item.texture = body.GetSprite()->Texture(isHighDPI, layout);
+	copy(layout->rect, layout->rect + 4, item.rect);
+	copy(layout->grid, layout->grid + 3, item.grid);
 	item.frame = body.GetFrame(step);
 	item.frameCount = body.GetSprite()->Frames();
 	
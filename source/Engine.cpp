@@ -13,6 +13,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Engine.h"
 
 #include "Audio.h"
+#include "Dictionary.h"
 #include "Effect.h"
 #include "FillShader.h"
 #include "Fleet.h"
@@ -61,6 +62,14 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 using namespace std;
 
 namespace {
+	// Attributes that are looked up every frame.
+	const Dictionary::Key ASTEROID_SCAN_POWER("asteroid scan power");
+	const Dictionary::Key ENERGY_CAPACITY("energy capacity");
+	const Dictionary::Key FUEL_CAPACITY("fuel capacity");
+	const Dictionary::Key INSCRUTABLE("inscrutable");
+	const Dictionary::Key JUMP_DRIVE("jump drive");
+	const Dictionary::Key TACTICAL_SCAN_POWER("tactical scan power");
+	
 	int RadarType(const Ship &ship, int step)
 	{
 		if(ship.GetPersonality().IsTarget() && !ship.IsDestroyed())
@@ -159,13 +168,31 @@ namespace {
 	}
 	
 	const double RADAR_SCALE = .025;
+	
+	// Number of objects handled by each batch in the parallel phases of a step.
+	// This is fixed, rather than based on the number of threads, so that each
+	// batch can be given a random seed that does not depend on the hardware.
+	const size_t BATCH_SIZE = 64;
+	const string PARALLEL_SIMULATION = "Parallel simulation";
+	
+	// Random numbers are only thread_local under Linux, so the parallel phases
+	// can only be deterministic there. Elsewhere, run every batch in order on
+	// the calculation thread.
+	unsigned WorkerCount()
+	{
+#ifdef __linux__
+		return max(1u, thread::hardware_concurrency()) - 1;
+#else
+		return 0;
+#endif
+	}
 }
 
 
 
 Engine::Engine(PlayerInfo &player)
 	: player(player), ai(ships, asteroids.Minables(), flotsam),
-	shipCollisions(256u, 32u)
+	workers(WorkerCount()), shipCollisions(CollisionSet::SWEEP)
 {
 	zoom = Preferences::ViewZoom();
 	
@@ -201,7 +228,7 @@ Engine::Engine(PlayerInfo &player)
 	
 	// Add all neighboring systems to the radar.
 	const System *targetSystem = flagship ? flagship->GetTargetSystem() : nullptr;
-	const set<const System *> &links = (flagship && flagship->Attributes().Get("jump drive")) ?
+	const set<const System *> &links = (flagship && flagship->Attributes().Get(JUMP_DRIVE)) ?
 		player.GetSystem()->Neighbors() : player.GetSystem()->Links();
 	for(const System *system : links)
 		radar[calcTickTock].AddPointer(
@@ -491,7 +518,7 @@ void Engine::Step(bool isActive)
 			else if(it.first->FiringFuel())
 			{
 				double remaining = flagship->Fuel()
-					* flagship->Attributes().Get("fuel capacity");
+					* flagship->Attributes().Get(FUEL_CAPACITY);
 				ammo.emplace_back(it.first,
 					remaining / it.first->FiringFuel());
 			}
@@ -579,7 +606,7 @@ void Engine::Step(bool isActive)
 	if(flagship)
 	{
 		info.SetBar("fuel", flagship->Fuel(),
-			flagship->Attributes().Get("fuel capacity") * .01);
+			flagship->Attributes().Get(FUEL_CAPACITY) * .01);
 		info.SetBar("energy", flagship->Energy());
 		double heat = flagship->Heat();
 		info.SetBar("heat", min(1., heat));
@@ -654,7 +681,7 @@ void Engine::Step(bool isActive)
 		
 		targetVector = targetAsteroid->Position() - center;
 		
-		if(flagship->Attributes().Get("tactical scan power"))
+		if(flagship->Attributes().Get(TACTICAL_SCAN_POWER))
 		{
 			info.SetCondition("range display");
 			int targetRange = round(targetAsteroid->Position().Distance(flagship->Position()));
@@ -697,7 +724,7 @@ void Engine::Step(bool isActive)
 			targetVector = target->Position() - center;
 			
 			// Check if the target is close enough to show tactical information.
-			double tacticalRange = 100. * sqrt(flagship->Attributes().Get("tactical scan power"));
+			double tacticalRange = 100. * sqrt(flagship->Attributes().Get(TACTICAL_SCAN_POWER));
 			double targetRange = target->Position().Distance(flagship->Position());
 			if(tacticalRange)
 			{
@@ -706,14 +733,14 @@ void Engine::Step(bool isActive)
 			}
 			// Actual tactical information requires a scrutable
 			// target that is within the tactical scanner range.
-			if((targetRange <= tacticalRange && !target->Attributes().Get("inscrutable"))
+			if((targetRange <= tacticalRange && !target->Attributes().Get(INSCRUTABLE))
 					|| (tacticalRange && target->IsYours()))
 			{
 				info.SetCondition("tactical display");
 				info.SetString("target crew", to_string(target->Crew()));
-				int fuel = round(target->Fuel() * target->Attributes().Get("fuel capacity"));
+				int fuel = round(target->Fuel() * target->Attributes().Get(FUEL_CAPACITY));
 				info.SetString("target fuel", to_string(fuel));
-				int energy = round(target->Energy() * target->Attributes().Get("energy capacity"));
+				int energy = round(target->Energy() * target->Attributes().Get(ENERGY_CAPACITY));
 				info.SetString("target energy", to_string(energy));
 				int heat = round(100. * target->Heat());
 				info.SetString("target heat", to_string(heat) + "%");
@@ -779,7 +806,7 @@ void Engine::Step(bool isActive)
 	}
 	
 	// Draw crosshairs on any minables in range of the flagship's scanners.
-	double scanRange = flagship ? 100. * sqrt(flagship->Attributes().Get("asteroid scan power")) : 0.;
+	double scanRange = flagship ? 100. * sqrt(flagship->Attributes().Get(ASTEROID_SCAN_POWER)) : 0.;
 	if(flagship && scanRange && !flagship->IsHyperspacing())
 		for(const shared_ptr<Minable> &minable : asteroids.Minables())
 		{
@@ -834,6 +861,7 @@ void Engine::Draw() const
 	draw[drawTickTock].Draw();
 	batchDraw[drawTickTock].Draw();
 	
+	RingShader::Bind();
 	for(const auto &it : statuses)
 	{
 		static const Color color[6] = {
@@ -847,11 +875,12 @@ void Engine::Draw() const
 		Point pos = it.position * zoom;
 		double radius = it.radius * zoom;
 		if(it.outer > 0.)
-			RingShader::Draw(pos, radius + 3., 1.5f, it.outer, color[it.type], 0.f, it.angle);
+			RingShader::Add(pos, radius + 3., 1.5f, it.outer, color[it.type], 0.f, it.angle);
 		double dashes = (it.type >= 2) ? 0. : 20. * min(1., zoom);
 		if(it.inner > 0.)
-			RingShader::Draw(pos, radius, 1.5f, it.inner, color[3 + it.type], dashes, it.angle);
+			RingShader::Add(pos, radius, 1.5f, it.inner, color[3 + it.type], dashes, it.angle);
 	}
+	RingShader::Unbind();
 	
 	// Draw the flagship highlight, if any.
 	if(highlightSprite)
@@ -874,6 +903,7 @@ void Engine::Draw() const
 	messageLine.SetWrapWidth(messageBox.Width());
 	messageLine.SetParagraphBreak(0.);
 	Point messagePoint = Point(messageBox.Left(), messageBox.Bottom());
+	Font::BeginBatch();
 	for(auto it = messages.rbegin(); it != messages.rend(); ++it)
 	{
 		messageLine.Wrap(it->message);
@@ -884,6 +914,7 @@ void Engine::Draw() const
 		Color color(alpha, 0.f);
 		messageLine.Draw(messagePoint, color);
 	}
+	Font::EndBatch();
 	
 	// Draw crosshairs around anything that is targeted.
 	for(const Target &target : targets)
@@ -972,16 +1003,19 @@ void Engine::Draw() const
 	// Draw escort status.
 	escorts.Draw(interface->GetBox("escorts"));
 	
-	// Upload any preloaded sprites that are now available. This is to avoid
-	// filling the entire backlog of sprites before landing on a planet.
-	GameData::Progress();
-	
 	if(Preferences::Has("Show CPU / GPU load"))
 	{
 		string loadString = to_string(lround(load * 100.)) + "% CPU";
 		Color color = *colors.Get("medium");
 		font.Draw(loadString,
 			Point(-10 - font.Width(loadString), Screen::Height() * -.5 + 5.), color);
+		string memoryString = to_string(GameData::SpriteMemory() >> 20) + " MB textures";
+		font.Draw(memoryString,
+			Point(-10 - font.Width(memoryString), Screen::Height() * -.5 + 25.), color);
+		string missionString = to_string(player.MissionsOffered()) + " / "
+			+ to_string(player.MissionsTested()) + " missions offered";
+		font.Draw(missionString,
+			Point(-10 - font.Width(missionString), Screen::Height() * -.5 + 45.), color);
 	}
 }
 
@@ -1215,6 +1249,17 @@ void Engine::CalculateStep()
 	// Move all the ships.
 	for(const shared_ptr<Ship> &it : ships)
 		MoveShip(it);
+	// Once every ship is in its final position, have the ships in this system
+	// fire their weapons. Each ship only modifies itself when firing, so this
+	// can be done in parallel. If this returns true the ship has at least one
+	// anti-missile system ready to fire.
+	RunBatches(firing.size(), [this](size_t begin, size_t end, Batch &batch)
+	{
+		for(size_t i = begin; i < end; ++i)
+			if(firing[i]->Fire(batch.projectiles, batch.visuals))
+				batch.hasAntiMissile.push_back(firing[i]);
+	});
+	firing.clear();
 	// If the flagship just began jumping, play the appropriate sound.
 	if(!wasHyperspacing && flagship && flagship->IsEnteringHyperspace())
 		Audio::Play(Audio::Get(flagship->IsUsingJumpDrive() ? "jump drive" : "hyperdrive"));
@@ -1245,14 +1290,22 @@ void Engine::CalculateStep()
 		it->Move(newVisuals);
 	Prune(flotsam);
 	
-	// Move the projectiles.
-	for(Projectile &projectile : projectiles)
-		projectile.Move(newVisuals, newProjectiles);
+	// Move the projectiles. A projectile only modifies itself when moving, and
+	// the ships it may be tracking are not moving now, so this can be done in
+	// parallel.
+	RunBatches(projectiles.size(), [this](size_t begin, size_t end, Batch &batch)
+	{
+		for(size_t i = begin; i < end; ++i)
+			projectiles[i].Move(batch.visuals, batch.projectiles);
+	});
 	Prune(projectiles);
 	
 	// Move the visuals.
-	for(Visual &visual : visuals)
-		visual.Move();
+	RunBatches(visuals.size(), [this](size_t begin, size_t end, Batch &batch)
+	{
+		for(size_t i = begin; i < end; ++i)
+			visuals[i].Move();
+	});
 	Prune(visuals);
 	
 	// Perform various minor actions.
@@ -1278,9 +1331,17 @@ void Engine::CalculateStep()
 	// Populate the collision detection lookup sets.
 	FillCollisionSets();
 	
-	// Perform collision detection.
-	for(Projectile &projectile : projectiles)
-		DoCollisions(projectile);
+	// Perform collision detection. Finding what each projectile hit does not
+	// modify anything, so that is done in parallel. Then, the damage is done in
+	// the same order as the projectiles, so it does not depend on thread timing.
+	collisions.assign(projectiles.size(), Collision());
+	RunBatches(projectiles.size(), [this](size_t begin, size_t end, Batch &batch)
+	{
+		for(size_t i = begin; i < end; ++i)
+			FindCollision(projectiles[i], collisions[i], batch.inRange);
+	});
+	for(size_t i = 0; i < projectiles.size(); ++i)
+		DoCollisions(projectiles[i], collisions[i]);
 	// Now that collision detection is done, clear the cache of ships with anti-
 	// missile systems ready to fire.
 	hasAntiMissile.clear();
@@ -1431,10 +1492,47 @@ void Engine::MoveShip(const shared_ptr<Ship> &ship)
 	// Launch fighters.
 	ship->Launch(newShips, newVisuals);
 	
-	// Fire weapons. If this returns true the ship has at least one anti-missile
-	// system ready to fire.
-	if(ship->Fire(newProjectiles, newVisuals))
-		hasAntiMissile.push_back(ship.get());
+	// Weapons are fired once all the ships have moved.
+	firing.push_back(ship.get());
+}
+
+
+
+// Split the given number of objects into fixed-size batches and call the given
+// function on each batch, using the worker threads if parallel simulation is
+// turned on. Each batch gets its own random seed and its own buffers for any
+// new objects it creates, which are then added to the new object lists in
+// batch order. That way the results are identical no matter how many threads
+// the batches were split across, or whether they were run in parallel at all.
+template <class Function>
+void Engine::RunBatches(size_t count, Function function)
+{
+	unsigned batchCount = (count + BATCH_SIZE - 1) / BATCH_SIZE;
+	if(!batchCount)
+		return;
+	if(batches.size() < batchCount)
+		batches.resize(batchCount);
+	
+	// Running a batch on this thread reseeds its random number generator, so
+	// pick the seed it should continue with afterwards, too.
+	uint64_t seed = (static_cast<uint64_t>(Random::Int()) << 32) | Random::Int();
+	uint64_t resume = (static_cast<uint64_t>(Random::Int()) << 32) | Random::Int();
+	workers.Run(batchCount, [&](unsigned i)
+	{
+		Random::Seed(seed + i);
+		size_t begin = i * BATCH_SIZE;
+		function(begin, min(count, begin + BATCH_SIZE), batches[i]);
+	}, Preferences::Has(PARALLEL_SIMULATION));
+	Random::Seed(resume);
+	
+	for(unsigned i = 0; i < batchCount; ++i)
+	{
+		Batch &batch = batches[i];
+		Append(newProjectiles, batch.projectiles);
+		Append(newVisuals, batch.visuals);
+		hasAntiMissile.insert(hasAntiMissile.end(), batch.hasAntiMissile.begin(), batch.hasAntiMissile.end());
+		batch.hasAntiMissile.clear();
+	}
 }
 
 
@@ -1444,8 +1542,23 @@ void Engine::FillCollisionSets()
 {
 	shipCollisions.Clear(step);
 	for(const shared_ptr<Ship> &it : ships)
+	{
+		// Bring every ship's mask up to date with this step now, because the
+		// collision queries run in parallel and must not modify any ship.
+		it->GetMask(step);
 		if(it->GetSystem() == player.GetSystem() && it->Zoom() == 1.)
 			shipCollisions.Add(*it);
+	}
+	
+	// A phasing projectile's target may no longer be in the list of ships (for
+	// example, if it was destroyed but is still referenced elsewhere).
+	for(const Projectile &projectile : projectiles)
+		if(projectile.GetWeapon().IsPhasing())
+		{
+			shared_ptr<Ship> target = projectile.TargetPtr();
+			if(target)
+				target->GetMask(step);
+		}
 	
 	// Get the ship collision set ready to query.
 	shipCollisions.Finish();
@@ -1640,10 +1753,10 @@ void Engine::HandleMouseClicks()
 	}
 	else if(isRightClick)
 		ai.IssueMoveTarget(player, clickPoint + center, playerSystem);
-	else if(flagship->Attributes().Get("asteroid scan power"))
+	else if(flagship->Attributes().Get(ASTEROID_SCAN_POWER))
 	{
 		// If the click was not on any ship, check if it was on a minable.
-		double scanRange = 100. * sqrt(flagship->Attributes().Get("asteroid scan power"));
+		double scanRange = 100. * sqrt(flagship->Attributes().Get(ASTEROID_SCAN_POWER));
 		for(const shared_ptr<Minable> &minable : asteroids.Minables())
 		{
 			Point position = minable->Position() - flagship->Position();
@@ -1662,17 +1775,17 @@ void Engine::HandleMouseClicks()
 
 
 
-// Perform collision detection. Note that unlike the preceding functions, this
-// one adds any visuals that are created directly to the main visuals list. If
-// this is multi-threaded in the future, that will need to change.
-void Engine::DoCollisions(Projectile &projectile)
+// Find what the given projectile hit this step. This does not modify anything
+// except the given collision and query results, so it can be done for many
+// projectiles at once on different threads. It must never change the state of
+// any Body, including the animation step that GetMask(step) would set; the
+// ships' steps are all set beforehand in FillCollisionSets().
+void Engine::FindCollision(const Projectile &projectile, Collision &collision, vector<Body *> &inRange) const
 {
 	// The asteroids can collide with projectiles, the same as any other
 	// object. If the asteroid turns out to be closer than the ship, it
 	// shields the ship (unless the projectile has a blast radius).
-	Point hitVelocity;
-	double closestHit = 1.;
-	shared_ptr<Ship> hit;
+	double &closestHit = collision.closestHit;
 	const Government *gov = projectile.GetGovernment();
 	
 	// If this "projectile" is a ship explosion, it always explodes.
@@ -1685,11 +1798,11 @@ void Engine::DoCollisions(Projectile &projectile)
 		if(target)
 		{
 			Point offset = projectile.Position() - target->Position();
-			double range = target->GetMask(step).Collide(offset, projectile.Velocity(), target->Facing());
+			double range = target->GetMask().Collide(offset, projectile.Velocity(), target->Facing());
 			if(range < 1.)
 			{
 				closestHit = range;
-				hit = target;
+				collision.ship = target.get();
 			}
 		}
 	}
@@ -1698,13 +1811,16 @@ void Engine::DoCollisions(Projectile &projectile)
 		// For weapons with a trigger radius, check if any detectable object will set it off.
 		double triggerRadius = projectile.GetWeapon().TriggerRadius();
 		if(triggerRadius)
-			for(const Body *body : shipCollisions.Circle(projectile.Position(), triggerRadius))
+		{
+			shipCollisions.Circle(projectile.Position(), triggerRadius, inRange);
+			for(const Body *body : inRange)
 				if(body == projectile.Target() || (gov->IsEnemy(body->GetGovernment())
 						&& reinterpret_cast<const Ship *>(body)->Cloaking() < 1.))
 				{
 					closestHit = 0.;
 					break;
 				}
+		}
 		
 		// If nothing triggered the projectile, check for collisions with ships.
 		if(closestHit > 0.)
@@ -1712,8 +1828,8 @@ void Engine::DoCollisions(Projectile &projectile)
 			Ship *ship = reinterpret_cast<Ship *>(shipCollisions.Line(projectile, &closestHit));
 			if(ship)
 			{
-				hit = ship->shared_from_this();
-				hitVelocity = ship->Velocity();
+				collision.ship = ship;
+				collision.moving = ship;
 			}
 		}
 		// "Phasing" projectiles can pass through asteroids. For all other
@@ -1721,20 +1837,37 @@ void Engine::DoCollisions(Projectile &projectile)
 		// ship that they have hit.
 		if(!projectile.GetWeapon().IsPhasing())
 		{
-			Body *asteroid = asteroids.Collide(projectile, &closestHit);
+			Body *asteroid = asteroids.Collide(projectile, &closestHit, &collision.minable);
 			if(asteroid)
 			{
-				hitVelocity = asteroid->Velocity();
-				hit.reset();
+				collision.moving = asteroid;
+				collision.ship = nullptr;
 			}
 		}
 	}
+}
+
+
+
+// Apply the effects of what the given projectile hit. Note that unlike the
+// preceding functions, this one adds any visuals that are created directly to
+// the main visuals list, so it must be done on the calculation thread.
+void Engine::DoCollisions(Projectile &projectile, const Collision &collision)
+{
+	double closestHit = collision.closestHit;
+	const Government *gov = projectile.GetGovernment();
+	shared_ptr<Ship> hit;
+	if(collision.ship)
+		hit = collision.ship->shared_from_this();
+	if(collision.minable)
+		collision.minable->TakeDamage(projectile);
 	
 	// Check if the projectile hit something.
 	if(closestHit < 1.)
 	{
 		// Create the explosion the given distance along the projectile's
 		// motion path for this step.
+		Point hitVelocity = collision.moving ? collision.moving->Velocity() : Point();
 		projectile.Explode(visuals, closestHit, hitVelocity);
 		
 		// If this projectile has a blast radius, find all ships within its
@@ -1746,7 +1879,8 @@ void Engine::DoCollisions(Projectile &projectile)
 			// Even friendly ships can be hit by the blast, unless it is a
 			// "safe" weapon.
 			Point hitPos = projectile.Position() + closestHit * projectile.Velocity();
-			for(Body *body : shipCollisions.Circle(hitPos, blastRadius))
+			shipCollisions.Circle(hitPos, blastRadius, inRange);
+			for(Body *body : inRange)
 			{
 				Ship *ship = reinterpret_cast<Ship *>(body);
 				if(isSafe && projectile.Target() != ship && !gov->IsEnemy(ship->GetGovernment()))
@@ -1788,7 +1922,8 @@ void Engine::DoCollection(Flotsam &flotsam)
 {
 	// Check if any ship can pick up this flotsam. Cloaked ships cannot act.
 	Ship *collector = nullptr;
-	for(Body *body : shipCollisions.Circle(flotsam.Position(), 5.))
+	shipCollisions.Circle(flotsam.Position(), 5., inRange);
+	for(Body *body : inRange)
 	{
 		Ship *ship = reinterpret_cast<Ship *>(body);
 		if(!ship->CannotAct() && ship != flotsam.Source() && ship->Cargo().Free() >= flotsam.UnitSize())
@@ -1881,7 +2016,7 @@ void Engine::FillRadar()
 	if(flagship)
 	{
 		const System *targetSystem = flagship->GetTargetSystem();
-		const set<const System *> &links = (flagship->Attributes().Get("jump drive")) ?
+		const set<const System *> &links = (flagship->Attributes().Get(JUMP_DRIVE)) ?
 			playerSystem->Neighbors() : playerSystem->Links();
 		for(const System *system : links)
 			radar[calcTickTock].AddPointer(
@@ -24,6 +24,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Point.h"
 #include "Radar.h"
 #include "Rectangle.h"
+#include "WorkerPool.h"
 
 #include <condition_variable>
 #include <list>
@@ -33,8 +34,10 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include <utility>
 #include <vector>
 
+class Body;
 class Flotsam;
 class Government;
+class Minable;
 class NPC;
 class Outfit;
 class PlanetLabel;
@@ -93,6 +96,9 @@ private:
 	
 	void MoveShip(const std::shared_ptr<Ship> &ship);
 	
+	template <class Function>
+	void RunBatches(size_t count, Function function);
+	
 	void SpawnFleets();
 	void SpawnPersons();
 	void SendHails();
@@ -100,7 +106,9 @@ private:
 	
 	void FillCollisionSets();
 	
-	void DoCollisions(Projectile &projectile);
+	class Collision;
+	void FindCollision(const Projectile &projectile, Collision &collision, std::vector<Body *> &inRange) const;
+	void DoCollisions(Projectile &projectile, const Collision &collision);
 	void DoCollection(Flotsam &flotsam);
 	void DoScanning(const std::shared_ptr<Ship> &ship);
 	
@@ -133,6 +141,32 @@ private:
 		double angle;
 	};
 	
+	// New objects created by one batch of a parallel phase of the step. Each
+	// batch is given its own buffers, and they are merged in batch order once
+	// the phase is done so that the results do not depend on thread timing.
+	class Batch {
+	public:
+		std::vector<Projectile> projectiles;
+		std::vector<Visual> visuals;
+		std::vector<Ship *> hasAntiMissile;
+		// Storage for the results of collision set circle queries.
+		std::vector<Body *> inRange;
+	};
+	
+	// What a projectile hit this step, if anything. These are found for all the
+	// projectiles in parallel, and then their effects are applied in order.
+	class Collision {
+	public:
+		// How far along its path this step the projectile hit something. If it
+		// did not hit anything, this is 1.
+		double closestHit = 1.;
+		// The explosion moves with this object. Its velocity is not looked up
+		// until the damage is done, because earlier hits may push a ship.
+		const Body *moving = nullptr;
+		Ship *ship = nullptr;
+		Minable *minable = nullptr;
+	};
+	
 	
 private:
 	PlayerInfo &player;
@@ -151,9 +185,16 @@ private:
 	
 	// Track which ships currently have anti-missiles ready to fire.
 	std::vector<Ship *> hasAntiMissile;
+	// Ships in the player's system that should fire their weapons this step.
+	std::vector<Ship *> firing;
 	
 	AI ai;
 	
+	// Worker threads that help the calculation thread with the parts of each
+	// step that can be done for each object independently.
+	WorkerPool workers;
+	std::vector<Batch> batches;
+	
 	std::thread calcThread;
 	std::condition_variable condition;
 	std::mutex swapMutex;
@@ -193,6 +234,9 @@ private:
 	int grudgeTime = 0;
 	
 	CollisionSet shipCollisions;
+	std::vector<Collision> collisions;
+	// Storage for the results of collision set circle queries.
+	std::vector<Body *> inRange;
 	
 	int alarmTime = 0;
 	double flash = 0.;
@@ -40,6 +40,7 @@ namespace {
 	string images;
 	string sounds;
 	string saves;
+	string cache;
 	
 	mutex errorMutex;
 	FILE *errorLog = nullptr;
@@ -176,6 +177,8 @@ void Files::Init(const char * const *argv)
 		if(str != nullptr)
 			SDL_free(str);
 	}
+	// The "cache" directory is only created if it is going to be used.
+	cache = config + "cache/";
 	
 	// Check that all the directories exist.
 	if(!Exists(data) || !Exists(images) || !Exists(sounds))
@@ -228,6 +231,13 @@ const string &Files::Saves()
 
 
 
+const string &Files::Cache()
+{
+	return cache;
+}
+
+
+
 vector<string> Files::List(string directory)
 {
 	if(directory.empty() || directory.back() != '/')
@@ -466,6 +476,19 @@ void Files::Delete(const string &filePath)
 
 
 
+bool Files::CreateFolder(const string &path)
+{
+	if(Exists(path))
+		return true;
+#if defined _WIN32
+	return CreateDirectoryW(ToUTF16(path).c_str(), nullptr);
+#else
+	return !mkdir(path.c_str(), 0755);
+#endif
+}
+
+
+
 // Get the filename from a path.
 string Files::Name(const string &path)
 {
@@ -37,6 +37,8 @@ public:
 	static const std::string &Images();
 	static const std::string &Sounds();
 	static const std::string &Saves();
+	// Directory for files that can be regenerated if they are deleted.
+	static const std::string &Cache();
 	
 	// Get a list of all regular files in the given directory.
 	static std::vector<std::string> List(std::string directory);
@@ -52,6 +54,9 @@ public:
 	static void Copy(const std::string &from, const std::string &to);
 	static void Move(const std::string &from, const std::string &to);
 	static void Delete(const std::string &filePath);
+	// Create the given directory if it does not exist yet. Returns false if it
+	// still does not exist afterwards.
+	static bool CreateFolder(const std::string &path);
 	
 	// Get the filename from a path.
 	static std::string Name(const std::string &path);
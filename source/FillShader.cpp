@@ -14,7 +14,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Color.h"
 #include "Point.h"
-#include "Screen.h"
+#include "PrimitiveBatch.h"
 #include "Shader.h"
 
 #include <stdexcept>
@@ -23,13 +23,7 @@ using namespace std;
 
 namespace {
 	Shader shader;
-	GLint scaleI;
-	GLint centerI;
-	GLint sizeI;
-	GLint colorI;
-	
-	GLuint vao;
-	GLuint vbo;
+	PrimitiveBatch batch;
 }
 
 
@@ -38,51 +32,37 @@ void FillShader::Init()
 {
 	static const char *vertexCode =
 		"uniform vec2 scale;\n"
-		"uniform vec2 center;\n"
-		"uniform vec2 size;\n"
 		
 		"in vec2 vert;\n"
+		"in vec2 center;\n"
+		"in vec2 size;\n"
+		"in vec4 color;\n"
+		"flat out vec4 fragColor;\n"
 		
 		"void main() {\n"
+		"  fragColor = color;\n"
 		"  gl_Position = vec4((center + vert * size) * scale, 0, 1);\n"
 		"}\n";
 
 	static const char *fragmentCode =
-		"uniform vec4 color = vec4(1, 1, 1, 1);\n"
+		"flat in vec4 fragColor;\n"
 		
 		"out vec4 finalColor;\n"
 		
 		"void main() {\n"
-		"  finalColor = color;\n"
+		"  finalColor = fragColor;\n"
 		"}\n";
 	
 	shader = Shader(vertexCode, fragmentCode);
-	scaleI = shader.Uniform("scale");
-	centerI = shader.Uniform("center");
-	sizeI = shader.Uniform("size");
-	colorI = shader.Uniform("color");
-	
-	// Generate the vertex data for drawing sprites.
-	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
-	
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
 	
-	GLfloat vertexData[] = {
+	// Generate the vertex data for drawing rectangles.
+	static const GLfloat vertexData[] = {
 		-.5f, -.5f,
 		 .5f, -.5f,
 		-.5f,  .5f,
 		 .5f,  .5f
 	};
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertexData), vertexData, GL_STATIC_DRAW);
-	
-	glEnableVertexAttribArray(shader.Attrib("vert"));
-	glVertexAttribPointer(shader.Attrib("vert"), 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
-	
-	// unbind the VBO and VAO
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	batch.Init(shader, vertexData, 4, GL_TRIANGLE_STRIP, {{"center", 2}, {"size", 2}, {"color", 4}});
 }
 
 
@@ -92,22 +72,10 @@ void FillShader::Fill(const Point &center, const Point &size, const Color &color
 	if(!shader.Object())
 		throw runtime_error("FillShader: Draw() called before Init().");
 	
-	glUseProgram(shader.Object());
-	glBindVertexArray(vao);
-	
-	GLfloat scale[2] = {2.f / Screen::Width(), -2.f / Screen::Height()};
-	glUniform2fv(scaleI, 1, scale);
-	
-	GLfloat centerV[2] = {static_cast<float>(center.X()), static_cast<float>(center.Y())};
-	glUniform2fv(centerI, 1, centerV);
-	
-	GLfloat sizeV[2] = {static_cast<float>(size.X()), static_cast<float>(size.Y())};
-	glUniform2fv(sizeI, 1, sizeV);
-	
-	glUniform4fv(colorI, 1, color.Get());
-	
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-	
-	glBindVertexArray(0);
-	glUseProgram(0);
+	const float *rgba = color.Get();
+	GLfloat values[8] = {
+		static_cast<float>(center.X()), static_cast<float>(center.Y()),
+		static_cast<float>(size.X()), static_cast<float>(size.Y()),
+		rgba[0], rgba[1], rgba[2], rgba[3]};
+	batch.Add(values);
 }
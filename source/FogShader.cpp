@@ -23,6 +23,8 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <set>
 #include <vector>
 
 using namespace std;
@@ -35,9 +37,9 @@ namespace {
 	const int DIAG = 7;
 	// Limit distances to the size of an unsigned char.
 	const int LIMIT = 255;
-	// Pad beyond the screen enough to include any system that might "cast light"
-	// on the on-screen view.
-	const int PAD = LIMIT / ORTH;
+	// Pad beyond the galaxy enough that the mask is fully dark at its edges. A
+	// system can only "cast light" this many cells away.
+	const int PAD = LIMIT / ORTH + 1;
 	
 	// OpenGL objects:
 	Shader shader;
@@ -47,14 +49,132 @@ namespace {
 	GLuint vbo;
 	GLuint texture = 0;
 	
-	// Keep track of the previous frame's view so that if it is unchanged we can
-	// skip regenerating the mask.
-	double previousZoom = 0.;
-	double previousLeft = 0.;
-	double previousTop = 0.;
-	int previousColumns = 0;
-	int previousRows = 0;
-	Point previousCenter;
+	// The mask covers the whole galaxy, with one cell for every GRID units. It
+	// only has to be updated when the player visits more systems, not every
+	// time the view moves. The position of the first cell, in map coordinates:
+	Point origin;
+	int columns = 0;
+	int rows = 0;
+	// For each cell, the distance to the nearest visited system, and the fog
+	// opacity that distance translates to.
+	vector<unsigned char> distance;
+	vector<unsigned char> mask;
+	// Systems that have already been added to the mask.
+	set<const System *> lit;
+	const PlayerInfo *previousPlayer = nullptr;
+	bool shouldUpdate = true;
+	
+	
+	// Strech the distance values so there is no shading up to about 200 pixels
+	// away, then it transitions somewhat quickly.
+	unsigned char Stretch(int value)
+	{
+		return max(0, min(LIMIT, (value - 60) * 4));
+	}
+	
+	// Mark the given cell as containing a visited system. Only the cells near
+	// it can be affected, and the distance to each of them is the length of the
+	// shortest path of orthogonal and diagonal steps.
+	void Light(int cx, int cy)
+	{
+		for(int y = max(0, cy - PAD); y <= min(rows - 1, cy + PAD); ++y)
+			for(int x = max(0, cx - PAD); x <= min(columns - 1, cx + PAD); ++x)
+			{
+				int dx = abs(x - cx);
+				int dy = abs(y - cy);
+				int value = DIAG * min(dx, dy) + ORTH * abs(dx - dy);
+				
+				size_t index = x + y * columns;
+				if(value < distance[index])
+				{
+					distance[index] = value;
+					mask[index] = Stretch(value);
+				}
+			}
+	}
+	
+	// Bring the mask up to date with the systems the player has visited.
+	void Update(const PlayerInfo &player)
+	{
+		// Find the grid cells that the map spans. The edges of the grid are
+		// rounded to a multiple of the cell size.
+		double left = 0.;
+		double top = 0.;
+		double right = 0.;
+		double bottom = 0.;
+		for(const auto &it : GameData::Systems())
+		{
+			const System &system = it.second;
+			if(system.Name().empty())
+				continue;
+			left = min(left, system.Position().X());
+			top = min(top, system.Position().Y());
+			right = max(right, system.Position().X());
+			bottom = max(bottom, system.Position().Y());
+		}
+		Point corner(GRID * (floor(left / GRID) - PAD), GRID * (floor(top / GRID) - PAD));
+		int newColumns = ceil(right / GRID) + PAD + 1 - corner.X() / GRID;
+		int newRows = ceil(bottom / GRID) + PAD + 1 - corner.Y() / GRID;
+		// Round up to a multiple of 4 so the rows will be 32-bit aligned.
+		newColumns = (newColumns + 3) & ~3;
+		
+		// If the galaxy has changed shape, or if any systems have become
+		// unvisited, the mask must be generated from scratch.
+		bool sizeChanged = (!texture || newColumns != columns || newRows != rows);
+		bool rebuild = (sizeChanged || &player != previousPlayer
+			|| corner.X() != origin.X() || corner.Y() != origin.Y());
+		for(auto it = lit.begin(); !rebuild && it != lit.end(); ++it)
+			rebuild = !player.HasVisited(*it);
+		if(rebuild)
+		{
+			origin = corner;
+			columns = newColumns;
+			rows = newRows;
+			previousPlayer = &player;
+			lit.clear();
+			distance.assign(rows * columns, LIMIT);
+			mask.assign(rows * columns, Stretch(LIMIT));
+		}
+		
+		// Add any newly visited systems to the mask.
+		bool changed = rebuild;
+		for(const auto &it : GameData::Systems())
+		{
+			const System &system = it.second;
+			if(system.Name().empty() || !player.HasVisited(&system) || !lit.insert(&system).second)
+				continue;
+			
+			Point pos = (system.Position() - origin) / GRID;
+			Light(round(pos.X()), round(pos.Y()));
+			changed = true;
+		}
+		if(!changed)
+			return;
+		
+		const void *data = &mask.front();
+		// Set up the OpenGL texture if it doesn't exist yet.
+		if(sizeChanged)
+		{
+			// If the texture size changed, it must be reallocated.
+			if(texture)
+				glDeleteTextures(1, &texture);
+			
+			glGenTextures(1, &texture);
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			
+			// Upload the new "image."
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, columns, rows, 0, GL_RED, GL_UNSIGNED_BYTE, data);
+		}
+		else
+		{
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, columns, rows, GL_RED, GL_UNSIGNED_BYTE, data);
+		}
+	}
 }
 
 
@@ -69,8 +189,8 @@ void FogShader::Init()
 		"out vec2 fragTexCoord;\n"
 		
 		"void main() {\n"
-		"  gl_Position = vec4(corner + vert * dimensions, 0, 1);\n"
-		"  fragTexCoord = vert;\n"
+		"  gl_Position = vec4(2 * vert.x - 1, 1 - 2 * vert.y, 0, 1);\n"
+		"  fragTexCoord = corner + vert * dimensions;\n"
 		"}\n";
 
 	static const char *fragmentCode =
@@ -119,119 +239,38 @@ void FogShader::Init()
 
 
 
+// Check for newly visited systems the next time the fog is drawn.
 void FogShader::Redraw()
 {
-	previousZoom = 0.;
+	shouldUpdate = true;
 }
 
 
 
 void FogShader::Draw(const Point &center, double zoom, const PlayerInfo &player)
 {
-	// Generate a scaled-down mask image that represents the entire screen plus
-	// enough pixels beyond the screen to include any systems that may be off
-	// screen but close enough to "illuminate" part of the on-screen map.
-	double left = Screen::Left() - GRID * PAD * zoom + fmod(center.X(), GRID) * zoom;
-	double top = Screen::Top() - GRID * PAD * zoom + fmod(center.Y(), GRID) * zoom;
-	int columns = ceil(Screen::Width() / (GRID * zoom)) + 1 + 2 * PAD;
-	int rows = ceil(Screen::Height() / (GRID * zoom)) + 1 + 2 * PAD;
-	// Round up to a multiple of 4 so the rows will be 32-bit aligned.
-	columns = (columns + 3) & ~3;
-	
-	// To avoid extra work, don't regenerate the mask buffer if the view has not
-	// moved. This might cause an inaccurate mask if you explore more systems,
-	// come back to the original, and view the map again without viewing it in
-	// between. But, that's an unlikely situation.
-	bool shouldRegenerate = (
-		zoom != previousZoom || center.X() != previousCenter.X() || center.Y() != previousCenter.Y() ||
-		left != previousLeft || top != previousTop || columns != previousColumns || rows != previousRows);
-	if(shouldRegenerate)
+	if(shouldUpdate || &player != previousPlayer)
 	{
-		bool sizeChanged = (!texture || columns != previousColumns || rows != previousRows);
-		
-		// Remember the current viewport attributes.
-		previousZoom = zoom;
-		previousCenter = center;
-		previousLeft = left;
-		previousTop = top;
-		previousColumns = columns;
-		previousRows = rows;
-		
-		// This buffer will hold the mask image.
-		vector<unsigned char> buffer(rows * columns, LIMIT);
-	
-		// For each system the player knows about, its "distance" pixel in the
-		// buffer should be set to 0.
-		for(const auto &it : GameData::Systems())
-		{
-			const System &system = it.second;
-			if(system.Name().empty() || !player.HasVisited(&system))
-				continue;
-			Point pos = zoom * (system.Position() + center);
-		
-			int x = round((pos.X() - left) / (GRID * zoom));
-			int y = round((pos.Y() - top) / (GRID * zoom));
-			if(x >= 0 && y >= 0 && x < columns && y < rows)
-				buffer[x + y * columns] = 0;
-		}
-	
-		// Distance transformation: make two passes through the buffer. In the first
-		// pass, propagate down and to the right. In the second, propagate in the
-		// opposite direction. Once these two passes are done, each value is equal
-		for(int y = 1; y < rows; ++y)
-			for(int x = 1; x < columns; ++x)
-				buffer[x + y * columns] = min<int>(buffer[x + y * columns], min(
-					ORTH + min(buffer[(x - 1) + y * columns], buffer[x + (y - 1) * columns]),
-					DIAG + min(buffer[(x - 1) + (y - 1) * columns], buffer[(x + 1) + (y - 1) * columns])));
-		for(int y = rows - 2; y >= 0; --y)
-			for(int x = columns - 2; x >= 0; --x)
-				buffer[x + y * columns] = min<int>(buffer[x + y * columns], min(
-					ORTH + min(buffer[(x + 1) + y * columns], buffer[x + (y + 1) * columns]),
-					DIAG + min(buffer[(x - 1) + (y + 1) * columns], buffer[(x + 1) + (y + 1) * columns])));
-	
-		// Strech the distance values so there is no shading up to about 200 pixels
-		// away, then it transitions somewhat quickly.
-		for(unsigned char &value : buffer)
-			value = max(0, min(LIMIT, (value - 60) * 4));
-		const void *data = &buffer.front();
-		
-		// Set up the OpenGL texture if it doesn't exist yet.
-		if(sizeChanged)
-		{
-			// If the texture size changed, it must be reallocated.
-			if(texture)
-				glDeleteTextures(1, &texture);
-			
-			glGenTextures(1, &texture);
-			glBindTexture(GL_TEXTURE_2D, texture);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-			
-			// Upload the new "image."
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, columns, rows, 0, GL_RED, GL_UNSIGNED_BYTE, data);
-		}
-		else
-		{
-			glBindTexture(GL_TEXTURE_2D, texture);
-			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, columns, rows, GL_RED, GL_UNSIGNED_BYTE, data);
-		}
+		Update(player);
+		shouldUpdate = false;
 	}
-	else
-		glBindTexture(GL_TEXTURE_2D, texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
 	
 	// Set up to draw the image.
 	glUseProgram(shader.Object());
 	glBindVertexArray(vao);
 	
+	// The fog covers the whole screen. Find the texture coordinates of the
+	// screen's top left corner, and how much of the texture the screen spans.
+	// The center of each texel is where the grid point it represents is.
+	Point topLeft = (Point(Screen::Left(), Screen::Top()) / zoom - center - origin) / GRID + Point(.5, .5);
 	GLfloat corner[2] = {
-		static_cast<float>(left - .5 * GRID * zoom) / (.5f * Screen::Width()),
-		static_cast<float>(top - .5 * GRID * zoom) / (-.5f * Screen::Height())};
+		static_cast<float>(topLeft.X() / columns),
+		static_cast<float>(topLeft.Y() / rows)};
 	glUniform2fv(cornerI, 1, corner);
 	GLfloat dimensions[2] = {
-		GRID * static_cast<float>(zoom) * (columns + 1.f) / (.5f * Screen::Width()),
-		GRID * static_cast<float>(zoom) * (rows + 1.f) / (-.5f * Screen::Height())};
+		static_cast<float>(Screen::Width() / (zoom * GRID * columns)),
+		static_cast<float>(Screen::Height() / (zoom * GRID * rows))};
 	glUniform2fv(dimensionsI, 1, dimensions);
 	
 	// Call the shader program to draw the image.
@@ -21,42 +21,45 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 
 using namespace std;
 
 namespace {
 	bool showUnderlines = false;
 	
+	// Nesting depth of the currently open text batch, and the fonts that have
+	// glyphs queued up in it.
+	int batchDepth = 0;
+	vector<const Font *> batchFonts;
+	
 	const char *vertexCode =
 		// "scale" maps pixel coordinates to GL coordinates (-1 to 1).
 		"uniform vec2 scale;\n"
-		// The (x, y) coordinates of the top left corner of the glyph.
-		"uniform vec2 position;\n"
-		// The glyph to draw. (ASCII value - 32).
-		"uniform int glyph;\n"
-		// Aspect ratio of rendered glyph (unity by default).
-		"uniform float aspect = 1.f;\n"
 		
-		// Inputs from the VBO.
+		// Inputs from the VBO: the position of this corner of the glyph, its
+		// texture coordinates, and the color of the text.
 		"in vec2 vert;\n"
 		"in vec2 corner;\n"
+		"in vec4 vertColor;\n"
 		
 		// Output to the fragment shader.
 		"out vec2 texCoord;\n"
+		"out vec4 color;\n"
 		
-		// Pick the proper glyph out of the texture.
 		"void main() {\n"
-		"  texCoord = vec2((glyph + corner.x) / 98.f, corner.y);\n"
-		"  gl_Position = vec4((aspect * vert.x + position.x) * scale.x, (vert.y + position.y) * scale.y, 0, 1);\n"
+		"  texCoord = corner;\n"
+		"  color = vertColor;\n"
+		"  gl_Position = vec4(vert * scale, 0, 1);\n"
 		"}\n";
 	
 	const char *fragmentCode =
-		// The user must supply a texture and a color (white by default).
+		// The user must supply a texture.
 		"uniform sampler2D tex;\n"
-		"uniform vec4 color = vec4(1, 1, 1, 1);\n"
 		
-		// This comes from the vertex shader.
+		// These come from the vertex shader.
 		"in vec2 texCoord;\n"
+		"in vec4 color;\n"
 		
 		// Output color.
 		"out vec4 finalColor;\n"
@@ -67,13 +70,19 @@ namespace {
 		"}\n";
 	
 	const int KERN = 2;
+	// Each glyph is drawn as two triangles. These are the corners of the
+	// glyph that each of the six vertices uses, in the order that the
+	// triangle strip used to draw them in.
+	const int CORNER_X[6] = {0, 0, 1, 1, 0, 1};
+	const int CORNER_Y[6] = {0, 1, 0, 0, 1, 1};
+	const int VERTEX_FLOATS = 8;
 }
 
 
 
 Font::Font()
-	: texture(0), vao(0), vbo(0), colorI(0), scaleI(0), glyphI(0), aspectI(0),
-	  positionI(0), height(0), space(0), screenWidth(0), screenHeight(0)
+	: texture(0), vao(0), vbo(0), scaleI(0), glyphWidth(0.f), glyphHeight(0.f),
+	  height(0), space(0), screenWidth(0), screenHeight(0)
 {
 }
 
@@ -110,21 +119,6 @@ void Font::Draw(const string &str, const Point &point, const Color &color) const
 
 void Font::DrawAliased(const string &str, double x, double y, const Color &color) const
 {
-	glUseProgram(shader.Object());
-	glBindTexture(GL_TEXTURE_2D, texture);
-	glBindVertexArray(vao);
-	
-	glUniform4fv(colorI, 1, color.Get());
-	
-	// Update the scale, only if the screen size has changed.
-	if(Screen::Width() != screenWidth || Screen::Height() != screenHeight)
-	{
-		screenWidth = Screen::Width();
-		screenHeight = Screen::Height();
-		GLfloat scale[2] = {2.f / screenWidth, -2.f / screenHeight};
-		glUniform2fv(scaleI, 1, scale);
-	}
-	
 	GLfloat textPos[2] = {
 		static_cast<float>(x - 1.),
 		static_cast<float>(y)};
@@ -150,31 +144,22 @@ void Font::DrawAliased(const string &str, double x, double y, const Color &color
 			continue;
 		}
 		
-		glUniform1i(glyphI, glyph);
-		glUniform1f(aspectI, 1.f);
-		
 		textPos[0] += advance[previous * GLYPHS + glyph] + KERN;
-		glUniform2fv(positionI, 1, textPos);
-		
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+		AddGlyph(glyph, textPos, 1.f, color);
 		
 		if(underlineChar)
 		{
-			glUniform1i(glyphI, underscoreGlyph);
-			glUniform1f(aspectI, static_cast<float>(advance[glyph * GLYPHS] + KERN)
-				/ (advance[underscoreGlyph * GLYPHS] + KERN));
-			
-			glUniform2fv(positionI, 1, textPos);
-			
-			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+			AddGlyph(underscoreGlyph, textPos, static_cast<float>(advance[glyph * GLYPHS] + KERN)
+				/ (advance[underscoreGlyph * GLYPHS] + KERN), color);
 			underlineChar = false;
 		}
 		
 		previous = glyph;
 	}
 	
-	glBindVertexArray(0);
-	glUseProgram(0);
+	// If no batch is open, draw this text right away.
+	if(!batchDepth)
+		Flush();
 }
 
 
@@ -344,6 +329,25 @@ void Font::ShowUnderlines(bool show)
 
 
 
+void Font::BeginBatch()
+{
+	++batchDepth;
+}
+
+
+
+void Font::EndBatch()
+{
+	if(!batchDepth || --batchDepth)
+		return;
+	
+	for(const Font *font : batchFonts)
+		font->Flush();
+	batchFonts.clear();
+}
+
+
+
 int Font::Glyph(char c, bool isAfterSpace)
 {
 	// Curly quotes.
@@ -437,36 +441,34 @@ void Font::CalculateAdvances(ImageBuffer &image)
 
 void Font::SetUpShader(float glyphW, float glyphH)
 {
-	glyphW *= .5f;
-	glyphH *= .5f;
+	glyphWidth = glyphW * .5f;
+	glyphHeight = glyphH * .5f;
 	
 	shader = Shader(vertexCode, fragmentCode);
 	glUseProgram(shader.Object());
 	glUniform1i(shader.Uniform("tex"), 0);
 	glUseProgram(0);
 	
-	// Create the VAO and VBO.
+	// Create the VAO and VBO. The glyph data is streamed into the VBO each
+	// time it is drawn.
 	glGenVertexArrays(1, &vao);
 	glBindVertexArray(vao);
 	
 	glGenBuffers(1, &vbo);
 	glBindBuffer(GL_ARRAY_BUFFER, vbo);
 	
-	GLfloat vertices[] = {
-		   0.f,    0.f, 0.f, 0.f,
-		   0.f, glyphH, 0.f, 1.f,
-		glyphW,    0.f, 1.f, 0.f,
-		glyphW, glyphH, 1.f, 1.f
-	};
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-	
 	// connect the xy to the "vert" attribute of the vertex shader
+	const GLsizei stride = VERTEX_FLOATS * sizeof(GLfloat);
 	glEnableVertexAttribArray(shader.Attrib("vert"));
-	glVertexAttribPointer(shader.Attrib("vert"), 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), nullptr);
+	glVertexAttribPointer(shader.Attrib("vert"), 2, GL_FLOAT, GL_FALSE, stride, nullptr);
 	
 	glEnableVertexAttribArray(shader.Attrib("corner"));
 	glVertexAttribPointer(shader.Attrib("corner"), 2, GL_FLOAT, GL_FALSE,
-		4 * sizeof(GLfloat), (const GLvoid*)(2 * sizeof(GLfloat)));
+		stride, (const GLvoid*)(2 * sizeof(GLfloat)));
+	
+	glEnableVertexAttribArray(shader.Attrib("vertColor"));
+	glVertexAttribPointer(shader.Attrib("vertColor"), 4, GL_FLOAT, GL_FALSE,
+		stride, (const GLvoid*)(4 * sizeof(GLfloat)));
 	
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
@@ -475,9 +477,57 @@ void Font::SetUpShader(float glyphW, float glyphH)
 	screenWidth = 0;
 	screenHeight = 0;
 	
-	colorI = shader.Uniform("color");
 	scaleI = shader.Uniform("scale");
-	glyphI = shader.Uniform("glyph");
-	aspectI = shader.Uniform("aspect");
-	positionI = shader.Uniform("position");
+}
+
+
+
+// Queue up a quad for the given glyph.
+void Font::AddGlyph(int glyph, const GLfloat position[2], float aspect, const Color &color) const
+{
+	// If this is the first text queued for this font in the current batch,
+	// remember that it must be drawn when the batch ends.
+	if(batchDepth && vertices.empty())
+		batchFonts.push_back(this);
+	
+	const float *rgba = color.Get();
+	for(int i = 0; i < 6; ++i)
+	{
+		vertices.push_back(aspect * (CORNER_X[i] * glyphWidth) + position[0]);
+		vertices.push_back(CORNER_Y[i] * glyphHeight + position[1]);
+		vertices.push_back((glyph + CORNER_X[i]) / static_cast<float>(GLYPHS));
+		vertices.push_back(CORNER_Y[i]);
+		vertices.insert(vertices.end(), rgba, rgba + 4);
+	}
+}
+
+
+
+// Draw all the glyphs that have been queued up.
+void Font::Flush() const
+{
+	if(vertices.empty())
+		return;
+	
+	glUseProgram(shader.Object());
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	
+	// Update the scale, only if the screen size has changed.
+	if(Screen::Width() != screenWidth || Screen::Height() != screenHeight)
+	{
+		screenWidth = Screen::Width();
+		screenHeight = Screen::Height();
+		GLfloat scale[2] = {2.f / screenWidth, -2.f / screenHeight};
+		glUniform2fv(scaleI, 1, scale);
+	}
+	
+	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * vertices.size(), vertices.data(), GL_STREAM_DRAW);
+	glDrawArrays(GL_TRIANGLES, 0, vertices.size() / VERTEX_FLOATS);
+	vertices.clear();
+	
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+	glUseProgram(0);
 }
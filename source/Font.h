@@ -18,6 +18,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "gl_header.h"
 
 #include <string>
+#include <vector>
 
 class Color;
 class ImageBuffer;
@@ -28,7 +29,9 @@ class Point;
 // Class for drawing text in OpenGL. Each font is based on a single image with
 // glyphs for each character in ASCII order (not counting control characters).
 // The kerning between characters is automatically adjusted to look good. At the
-// moment only plain ASCII characters are supported, not Unicode.
+// moment only plain ASCII characters are supported, not Unicode. Each string is
+// drawn with a single draw call; to combine many strings into one draw call per
+// font, draw them in between calls to BeginBatch() and EndBatch().
 class Font {
 public:
 	Font();
@@ -51,6 +54,14 @@ public:
 	
 	static void ShowUnderlines(bool show);
 	
+	// While a batch is open, text is not drawn right away but queued up, and
+	// all the text queued for each font is drawn when the batch is closed. So,
+	// anything else drawn in the meantime will end up underneath the text, and
+	// overlapping text in two different fonts may not be drawn in order.
+	// Batches may be nested; the text is drawn when the outermost one ends.
+	static void BeginBatch();
+	static void EndBatch();
+	
 	
 private:
 	static int Glyph(char c, bool isAfterSpace);
@@ -58,6 +69,12 @@ private:
 	void CalculateAdvances(ImageBuffer &image);
 	void SetUpShader(float glyphW, float glyphH);
 	
+	// Queue up a quad for the given glyph, with its top left corner at the
+	// given position and its width scaled by the given amount.
+	void AddGlyph(int glyph, const GLfloat position[2], float aspect, const Color &color) const;
+	// Draw all the glyphs that have been queued up.
+	void Flush() const;
+	
 	
 private:
 	Shader shader;
@@ -65,11 +82,14 @@ private:
 	GLuint vao;
 	GLuint vbo;
 	
-	GLint colorI;
 	GLint scaleI;
-	GLint glyphI;
-	GLint aspectI;
-	GLint positionI;
+	
+	float glyphWidth;
+	float glyphHeight;
+	// Vertex data for the glyphs that are waiting to be drawn. Each glyph is
+	// six vertices (two triangles), each with eight attributes: the (x, y)
+	// position in pixels, the (s, t) texture coordinates, and the RGBA color.
+	mutable std::vector<GLfloat> vertices;
 	
 	int height;
 	int space;
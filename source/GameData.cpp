@@ -20,6 +20,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "DataFile.h"
 #include "DataNode.h"
 #include "DataWriter.h"
+#include "DistanceMap.h"
 #include "Effect.h"
 #include "Files.h"
 #include "FillShader.h"
@@ -29,11 +30,13 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Galaxy.h"
 #include "GameEvent.h"
 #include "Government.h"
+#include "ImageBuffer.h"
 #include "ImageSet.h"
 #include "Interface.h"
 #include "LineShader.h"
 #include "Minable.h"
 #include "Mission.h"
+#include "MissionIndex.h"
 #include "Music.h"
 #include "News.h"
 #include "Outfit.h"
@@ -42,6 +45,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Phrase.h"
 #include "Planet.h"
 #include "PointerShader.h"
+#include "Preferences.h"
 #include "Politics.h"
 #include "Random.h"
 #include "RingShader.h"
@@ -53,10 +57,12 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "StarField.h"
 #include "StartConditions.h"
 #include "System.h"
+#include "WorkerPool.h"
 
 #include <algorithm>
 #include <iostream>
 #include <map>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -75,6 +81,7 @@ namespace {
 	Set<Interface> interfaces;
 	Set<Minable> minables;
 	Set<Mission> missions;
+	MissionIndex missionIndex;
 	Set<Outfit> outfits;
 	Set<Person> persons;
 	Set<Phrase> phrases;
@@ -114,8 +121,6 @@ namespace {
 	SpriteQueue spriteQueue;
 	
 	vector<string> sources;
-	map<const Sprite *, shared_ptr<ImageSet>> deferred;
-	map<const Sprite *, int> preloaded;
 	
 	const Government *playerGovernment = nullptr;
 }
@@ -142,6 +147,15 @@ bool GameData::BeginLoad(const char * const *argv)
 		}
 	}
 	Files::Init(argv);
+	// The preferences affect how images are loaded, so load them first.
+	Preferences::Load();
+	if(Preferences::Has("Cache decoded graphics"))
+	{
+		if(Files::CreateFolder(Files::Cache()))
+			ImageBuffer::SetCacheDirectory(Files::Cache());
+		else
+			Files::LogError("Unable to create the image cache directory: \"" + Files::Cache() + "\"");
+	}
 	
 	// Initialize the list of "source" folders based on any active plugins.
 	LoadSources();
@@ -162,7 +176,7 @@ bool GameData::BeginLoad(const char * const *argv)
 		it.second->Check();
 		// For landscapes, remember all the source files but don't load them yet.
 		if(ImageSet::IsDeferred(it.first))
-			deferred[SpriteSet::Get(it.first)] = it.second;
+			spriteQueue.Defer(it.second);
 		else
 			spriteQueue.Add(it.second);
 	}
@@ -170,14 +184,38 @@ bool GameData::BeginLoad(const char * const *argv)
 	// Generate a catalog of music files.
 	Music::Init(sources);
 	
+	vector<string> dataFiles;
 	for(const string &source : sources)
 	{
 		// Iterate through the paths starting with the last directory given. That
 		// is, things in folders near the start of the path have the ability to
 		// override things in folders later in the path.
-		vector<string> dataFiles = Files::RecursiveList(source + "data/");
-		for(const string &path : dataFiles)
-			LoadFile(path, debugMode);
+		for(const string &path : Files::RecursiveList(source + "data/"))
+			if(path.length() >= 4 && !path.compare(path.length() - 4, 4, ".txt"))
+				dataFiles.push_back(path);
+	}
+	{
+		// Parsing each file is independent of all the others, so they can all
+		// be parsed in parallel. But, the order in which they are loaded does
+		// matter, so that must still be done one at a time. In debug mode, each
+		// file is instead parsed right before it is loaded, so that any errors
+		// in it are printed after its name rather than in thread order.
+		vector<DataFile> parsed(dataFiles.size());
+		if(!debugMode)
+		{
+			unsigned threads = thread::hardware_concurrency();
+			WorkerPool workers(threads > 1 ? threads - 1 : 0);
+			workers.Run(dataFiles.size(), [&](unsigned i) { parsed[i].Load(dataFiles[i]); });
+		}
+		for(size_t i = 0; i < dataFiles.size(); ++i)
+		{
+			if(debugMode)
+			{
+				Files::LogError("Parsing: " + dataFiles[i]);
+				parsed[i].Load(dataFiles[i]);
+			}
+			LoadFile(parsed[i]);
+		}
 	}
 	
 	// Now that all the stars are loaded, update the neighbor lists.
@@ -188,6 +226,9 @@ bool GameData::BeginLoad(const char * const *argv)
 	for(auto &it : persons)
 		it.second.FinishLoading();
 	startConditions.FinishLoading();
+	// Sort the missions by where they may be offered.
+	for(const auto &it : missions)
+		missionIndex.Add(it.second);
 	
 	// Store the current state, to revert back to later.
 	defaultFleets = fleets;
@@ -301,6 +342,7 @@ void GameData::LoadShaders()
 	RingShader::Init();
 	SpriteShader::Init();
 	BatchShader::Init();
+	Sprite::InitPlaceholder();
 	
 	background.Init(16384, 4096);
 }
@@ -314,49 +356,28 @@ double GameData::Progress()
 
 
 
-// Begin loading a sprite that was previously deferred. Currently this is
-// done with all landscapes to speed up the program's startup.
+// Upload any sprites that have finished loading, and update which sprites'
+// textures are resident. This must be called once per frame.
+void GameData::StepSprites()
+{
+	spriteQueue.Step();
+}
+
+
+
+// Get the number of bytes of texture memory the sprites are using.
+size_t GameData::SpriteMemory()
+{
+	return spriteQueue.ResidentBytes();
+}
+
+
+
+// Begin loading a sprite that is not loaded yet, because it will probably be
+// drawn soon. This is done with landscapes, which are not loaded at startup.
 void GameData::Preload(const Sprite *sprite)
 {
-	// Make sure this sprite actually is one that uses deferred loading.
-	auto dit = deferred.find(sprite);
-	if(!sprite || dit == deferred.end())
-		return;
-	
-	// If this sprite is one of the currently loaded ones, there is no need to
-	// load it again. But, make note of the fact that it is the most recently
-	// asked-for sprite.
-	map<const Sprite *, int>::iterator pit = preloaded.find(sprite);
-	if(pit != preloaded.end())
-	{
-		for(pair<const Sprite * const, int> &it : preloaded)
-			if(it.second < pit->second)
-				++it.second;
-		
-		pit->second = 0;
-		return;
-	}
-	
-	// This sprite is not currently preloaded. Check to see whether we already
-	// have the maximum number of sprites loaded, in which case the oldest one
-	// must be unloaded to make room for this one.
-	const string &name = sprite->Name();
-	pit = preloaded.begin();
-	while(pit != preloaded.end())
-	{
-		++pit->second;
-		if(pit->second >= 20)
-		{
-			spriteQueue.Unload(name);
-			pit = preloaded.erase(pit);
-		}
-		else
-			++pit;
-	}
-	
-	// Now, load all the files for this sprite.
-	preloaded[sprite] = 0;
-	spriteQueue.Add(dit->second);
+	spriteQueue.Preload(sprite);
 }
 
 
@@ -391,6 +412,9 @@ void GameData::Revert()
 	
 	politics.Reset();
 	purchases.clear();
+	// The systems' links may have changed, so any routes that were found
+	// using them are no longer valid.
+	DistanceMap::ClearRoutes();
 }
 
 
@@ -555,6 +579,8 @@ void GameData::UpdateNeighbors()
 {
 	for(auto &it : systems)
 		it.second.UpdateNeighbors(systems);
+	// Any routes that were found using the old links are now invalid.
+	DistanceMap::ClearRoutes();
 }
 
 
@@ -650,6 +676,15 @@ const Set<Mission> &GameData::Missions()
 
 
 
+// Get the missions that might be offered on the given planet (not counting
+// boarding missions), in the same order as in Missions().
+vector<const Mission *> GameData::MissionsAt(const Planet *planet)
+{
+	return missionIndex.Find(planet);
+}
+
+
+
 const Set<Outfit> &GameData::Outfits()
 {
 	return outfits;
@@ -905,16 +940,8 @@ void GameData::LoadSources()
 
 
 
-void GameData::LoadFile(const string &path, bool debugMode)
+void GameData::LoadFile(const DataFile &data)
 {
-	// This is an ordinary file. Check to see if it is an image.
-	if(path.length() < 4 || path.compare(path.length() - 4, 4, ".txt"))
-		return;
-	
-	DataFile data(path);
-	if(debugMode)
-		Files::LogError("Parsing: " + path);
-	
 	for(const DataNode &node : data)
 	{
 		const string &key = node.Token(0);
@@ -24,6 +24,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 class Color;
 class Conversation;
+class DataFile;
 class DataNode;
 class DataWriter;
 class Date;
@@ -63,8 +64,14 @@ public:
 	static void CheckReferences();
 	static void LoadShaders();
 	static double Progress();
-	// Begin loading a sprite that was previously deferred. Currently this is
-	// done with all landscapes to speed up the program's startup.
+	// Upload any sprites that have finished loading, and update which sprites'
+	// textures are resident. This must be called once per frame.
+	static void StepSprites();
+	// Get the number of bytes of texture memory the sprites are using.
+	static size_t SpriteMemory();
+	// Begin loading a sprite that is not loaded yet, because it will probably
+	// be drawn soon. This is done with landscapes, which are not loaded at
+	// startup.
 	static void Preload(const Sprite *sprite);
 	static void FinishLoading();
 	
@@ -101,6 +108,9 @@ public:
 	static const Set<Interface> &Interfaces();
 	static const Set<Minable> &Minables();
 	static const Set<Mission> &Missions();
+	// Get the missions that might be offered on the given planet (not counting
+	// boarding missions), in the same order as in Missions().
+	static std::vector<const Mission *> MissionsAt(const Planet *planet);
 	static const Set<Outfit> &Outfits();
 	static const Set<Sale<Outfit>> &Outfitters();
 	static const Set<Person> &Persons();
@@ -143,7 +153,7 @@ public:
 	
 private:
 	static void LoadSources();
-	static void LoadFile(const std::string &path, bool debugMode);
+	static void LoadFile(const DataFile &data);
 	static std::map<std::string, std::shared_ptr<ImageSet>> FindImages();
 	
 	static void PrintShipTable();
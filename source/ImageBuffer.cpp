@@ -13,11 +13,14 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "ImageBuffer.h"
 
 #include "File.h"
+#include "Files.h"
 
 #include <png.h>
 #include <jpeglib.h>
 
+#include <cstdint>
 #include <cstdio>
+#include <functional>
 #include <vector>
 
 using namespace std;
@@ -26,6 +29,21 @@ namespace {
 	bool ReadPNG(const string &path, ImageBuffer &buffer, int frame);
 	bool ReadJPG(const string &path, ImageBuffer &buffer, int frame);
 	void Premultiply(ImageBuffer &buffer, int frame, int additive);
+	bool ReadCache(const string &path, ImageBuffer &buffer, int frame);
+	void WriteCache(const string &path, const ImageBuffer &buffer, int frame);
+	
+	// Directory in which decoded images are cached, if any.
+	string cacheDirectory;
+}
+
+
+
+// Cache decoded images in the given directory, so that the next time they are
+// read they do not have to be decoded again. An empty string turns off the
+// cache. This must not be changed while images are being read.
+void ImageBuffer::SetCacheDirectory(const string &directory)
+{
+	cacheDirectory = directory;
 }
 
 
@@ -158,6 +176,12 @@ bool ImageBuffer::Read(const string &path, int frame)
 	if(!isPNG && !isJPG)
 		return false;
 	
+	// JPEG images are quick to decode, and much bigger once they are decoded,
+	// so only PNG images are cached.
+	bool useCache = (isPNG && !cacheDirectory.empty());
+	if(useCache && ReadCache(path, *this, frame))
+		return true;
+	
 	if(isPNG && !ReadPNG(path, *this, frame))
 		return false;
 	if(isJPG && !ReadJPG(path, *this, frame))
@@ -179,6 +203,8 @@ bool ImageBuffer::Read(const string &path, int frame)
 		if(isPNG || (isJPG && additive == 2))
 			Premultiply(*this, frame, additive);
 	}
+	if(useCache)
+		WriteCache(path, *this, frame);
 	return true;
 }
 
@@ -327,4 +353,76 @@ namespace {
 			}
 		}
 	}
+	
+	
+	
+	// Each cached image starts with this version number, followed by the
+	// source image's timestamp and dimensions and path. The pixels follow, with
+	// premultiplication already applied. The version must be changed whenever
+	// the format or the way images are converted changes.
+	const uint32_t CACHE_VERSION = 1;
+	
+	string CachePath(const string &path)
+	{
+		// Different paths may end up with the same name, but because the full
+		// path is stored in the file, that just means the image is not cached.
+		char name[20];
+		snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash<string>()(path)));
+		return cacheDirectory + name;
+	}
+	
+	
+	
+	bool ReadCache(const string &path, ImageBuffer &buffer, int frame)
+	{
+		File file(CachePath(path));
+		if(!file)
+			return false;
+		
+		// Make sure that the cached image is of this file, and is up to date.
+		uint32_t version = 0;
+		int64_t timestamp = 0;
+		int32_t size[2] = {0, 0};
+		uint32_t length = 0;
+		if(fread(&version, sizeof(version), 1, file) != 1 || version != CACHE_VERSION)
+			return false;
+		if(fread(&timestamp, sizeof(timestamp), 1, file) != 1 || fread(size, sizeof(int32_t), 2, file) != 2)
+			return false;
+		if(fread(&length, sizeof(length), 1, file) != 1 || length != path.length())
+			return false;
+		string source(length, '\0');
+		if(fread(&source[0], 1, length, file) != length || source != path)
+			return false;
+		if(timestamp != static_cast<int64_t>(Files::Timestamp(path)))
+			return false;
+		
+		// If the buffer is not yet allocated, allocate it.
+		buffer.Allocate(size[0], size[1]);
+		// Make sure this frame's dimensions are valid.
+		if(!size[0] || !size[1] || size[0] != buffer.Width() || size[1] != buffer.Height())
+			return false;
+		
+		size_t count = static_cast<size_t>(size[0]) * size[1];
+		return (fread(buffer.Begin(0, frame), sizeof(uint32_t), count, file) == count);
+	}
+	
+	
+	
+	void WriteCache(const string &path, const ImageBuffer &buffer, int frame)
+	{
+		File file(CachePath(path), true);
+		if(!file)
+			return;
+		
+		uint32_t version = CACHE_VERSION;
+		int64_t timestamp = Files::Timestamp(path);
+		int32_t size[2] = {buffer.Width(), buffer.Height()};
+		uint32_t length = path.length();
+		fwrite(&version, sizeof(version), 1, file);
+		fwrite(&timestamp, sizeof(timestamp), 1, file);
+		fwrite(size, sizeof(int32_t), 2, file);
+		fwrite(&length, sizeof(length), 1, file);
+		fwrite(path.data(), 1, length, file);
+		fwrite(buffer.Begin(0, frame), sizeof(uint32_t), static_cast<size_t>(size[0]) * size[1], file);
+	}
 }
@@ -24,6 +24,13 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 // on the file name, so that content creators do not have to save the images in
 // some sort of special format.
 class ImageBuffer {
+public:
+	// Cache decoded images in the given directory, so that the next time they
+	// are read they do not have to be decoded again. An empty string turns off
+	// the cache. This must not be changed while images are being read.
+	static void SetCacheDirectory(const std::string &directory);
+	
+	
 public:
 	// When initializing a buffer, we know the number of frames but not the size
 	// of them. So, it must be Allocate()d later.
@@ -52,7 +59,8 @@ public:
 	void ShrinkToHalfSize();
 	
 	// Read a single frame. Return false if an error is encountered - either the
-	// image is the wrong size, or it is not a supported image format.
+	// image is the wrong size, or it is not a supported image format. If there
+	// is an up to date copy of the decoded image in the cache, it is used.
 	bool Read(const std::string &path, int frame = 0);
 	
 	
@@ -198,16 +198,25 @@ void ImageSet::Load()
 	buffer[0].Clear(frames);
 	buffer[1].Clear(frames);
 	
-	// Check whether we need to generate collision masks.
-	bool makeMasks = IsMasked(name);
+	// Check whether we need to generate collision masks. If this sprite has
+	// been loaded before, it already has them.
+	bool makeMasks = IsMasked(name) && !isUploaded;
 	if(makeMasks)
 		masks.resize(frames);
+	// Ships are the targets of most collision and range checks, so it is worth
+	// caching their bounding boxes. Asteroids are round enough that the radius
+	// check alone rejects nearly as much.
+	bool cacheBounds = makeMasks && !name.compare(0, 5, "ship/");
 	
 	// Load the 1x sprites first, then the 2x sprites, because they are likely
 	// to be in separate locations on the disk. Create masks if needed.
 	for(size_t i = 0; i < frames; ++i)
 		if(buffer[0].Read(paths[0][i], i) && makeMasks)
+		{
 			masks[i].Create(buffer[0], i);
+			if(cacheBounds)
+				masks[i].CacheBounds();
+		}
 	// Now, load the 2x sprites, if they exist. Because the number of 1x frames
 	// is definitive, don't load any frames beyond the size of the 1x list.
 	for(size_t i = 0; i < frames && i < paths[1].size(); ++i)
@@ -218,11 +227,14 @@ void ImageSet::Load()
 
 // Create the sprite and upload the image data to the GPU. After this is
 // called, the internal image buffers and mask vector will be cleared, but
-// the paths are saved in case the sprite needs to be loaded again.
-void ImageSet::Upload(Sprite *sprite)
+// the paths are saved in case the sprite needs to be loaded again. If
+// withTextures is false, only the sprite's size and masks are filled in.
+void ImageSet::Upload(Sprite *sprite, bool withTextures)
 {
 	// Load the frames. This will clear the buffers and the mask vector.
-	sprite->AddFrames(buffer[0], false);
-	sprite->AddFrames(buffer[1], true);
-	sprite->AddMasks(masks);
+	sprite->AddFrames(buffer[0], false, withTextures);
+	sprite->AddFrames(buffer[1], true, withTextures);
+	if(!isUploaded)
+		sprite->AddMasks(masks);
+	isUploaded = true;
 }
@@ -59,12 +59,14 @@ public:
 	// an error for each missing frame. (It will be left uninitialized.)
 	void Check() const;
 	// Load all the frames. This should be called in one of the image-loading
-	// worker threads. This also generates collision masks if needed.
+	// worker threads. The first time, this also generates collision masks if
+	// needed; when the sprite is reloaded, it keeps the masks it already has.
 	void Load();
 	// Create the sprite and upload the image data to the GPU. After this is
 	// called, the internal image buffers and mask vector will be cleared, but
-	// the paths are saved in case the sprite needs to be loaded again.
-	void Upload(Sprite *sprite);
+	// the paths are saved in case the sprite needs to be loaded again. If
+	// withTextures is false, only the sprite's size and masks are filled in.
+	void Upload(Sprite *sprite, bool withTextures = true);
 	
 	
 private:
@@ -75,6 +77,8 @@ private:
 	// Data loaded from the images:
 	ImageBuffer buffer[2];
 	std::vector<Mask> masks;
+	// Whether this image set has been uploaded to its sprite before.
+	bool isUploaded = false;
 };
 
 
@@ -14,6 +14,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Color.h"
 #include "FillShader.h"
+#include "Font.h"
 #include "FontSet.h"
 #include "GameData.h"
 #include "Screen.h"
@@ -176,6 +177,7 @@ Point ItemInfoDisplay::Draw(Point point, const vector<string> &labels, const vec
 	table.SetHighlight(0, WIDTH);
 	table.DrawAt(point);
 	
+	Font::BeginBatch();
 	for(unsigned i = 0; i < labels.size() && i < values.size(); ++i)
 	{
 		if(labels[i].empty())
@@ -188,6 +190,7 @@ Point ItemInfoDisplay::Draw(Point point, const vector<string> &labels, const vec
 		table.Draw(labels[i], values[i].empty() ? valueColor : labelColor);
 		table.Draw(values[i], valueColor);
 	}
+	Font::EndBatch();
 	return table.GetPoint();
 }
 
@@ -14,7 +14,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Color.h"
 #include "Point.h"
-#include "Screen.h"
+#include "PrimitiveBatch.h"
 #include "Shader.h"
 
 #include <stdexcept>
@@ -23,14 +23,7 @@ using namespace std;
 
 namespace {
 	Shader shader;
-	GLint scaleI;
-	GLint startI;
-	GLint lengthI;
-	GLint widthI;
-	GLint colorI;
-	
-	GLuint vao;
-	GLuint vbo;
+	PrimitiveBatch batch;
 }
 
 
@@ -39,60 +32,44 @@ void LineShader::Init()
 {
 	static const char *vertexCode =
 		"uniform vec2 scale;\n"
-		"uniform vec2 start;\n"
-		"uniform vec2 len;\n"
-		"uniform vec2 width;\n"
 		
 		"in vec2 vert;\n"
+		"in vec2 start;\n"
+		"in vec2 len;\n"
+		"in vec2 width;\n"
+		"in vec4 color;\n"
 		"out vec2 tpos;\n"
-		"out float tscale;\n"
+		"flat out float tscale;\n"
+		"flat out vec4 fragColor;\n"
 		
 		"void main() {\n"
 		"  tpos = vert;\n"
 		"  tscale = length(len);\n"
+		"  fragColor = color;\n"
 		"  gl_Position = vec4((start + vert.x * len + vert.y * width) * scale, 0, 1);\n"
 		"}\n";
 
 	static const char *fragmentCode =
-		"uniform vec4 color = vec4(1, 1, 1, 1);\n"
-		
 		"in vec2 tpos;\n"
-		"in float tscale;\n"
+		"flat in float tscale;\n"
+		"flat in vec4 fragColor;\n"
 		"out vec4 finalColor;\n"
 		
 		"void main() {\n"
 		"  float alpha = min(tscale - abs(tpos.x * (2 * tscale) - tscale), 1 - abs(tpos.y));\n"
-		"  finalColor = color * alpha;\n"
+		"  finalColor = fragColor * alpha;\n"
 		"}\n";
 	
 	shader = Shader(vertexCode, fragmentCode);
-	scaleI = shader.Uniform("scale");
-	startI = shader.Uniform("start");
-	lengthI = shader.Uniform("len");
-	widthI = shader.Uniform("width");
-	colorI = shader.Uniform("color");
-	
-	// Generate the vertex data for drawing sprites.
-	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
-	
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
 	
-	GLfloat vertexData[] = {
+	// Generate the vertex data for drawing lines.
+	static const GLfloat vertexData[] = {
 		0.f, -1.f,
 		1.f, -1.f,
 		0.f,  1.f,
 		1.f,  1.f
 	};
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertexData), vertexData, GL_STATIC_DRAW);
-	
-	glEnableVertexAttribArray(shader.Attrib("vert"));
-	glVertexAttribPointer(shader.Attrib("vert"), 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
-	
-	// unbind the VBO and VAO
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	batch.Init(shader, vertexData, 4, GL_TRIANGLE_STRIP, {{"start", 2}, {"len", 2}, {"width", 2}, {"color", 4}});
 }
 
 
@@ -102,27 +79,13 @@ void LineShader::Draw(const Point &from, const Point &to, float width, const Col
 	if(!shader.Object())
 		throw runtime_error("LineShader: Draw() called before Init().");
 	
-	glUseProgram(shader.Object());
-	glBindVertexArray(vao);
-	
-	GLfloat scale[2] = {2.f / Screen::Width(), -2.f / Screen::Height()};
-	glUniform2fv(scaleI, 1, scale);
-	
-	GLfloat start[2] = {static_cast<float>(from.X()), static_cast<float>(from.Y())};
-	glUniform2fv(startI, 1, start);
-	
 	Point v = to - from;
 	Point u = v.Unit() * width;
-	GLfloat length[2] = {static_cast<float>(v.X()), static_cast<float>(v.Y())};
-	glUniform2fv(lengthI, 1, length);
-	
-	GLfloat w[2] = {static_cast<float>(u.Y()), static_cast<float>(-u.X())};
-	glUniform2fv(widthI, 1, w);
-	
-	glUniform4fv(colorI, 1, color.Get());
-	
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-	
-	glBindVertexArray(0);
-	glUseProgram(0);
+	const float *rgba = color.Get();
+	GLfloat values[10] = {
+		static_cast<float>(from.X()), static_cast<float>(from.Y()),
+		static_cast<float>(v.X()), static_cast<float>(v.Y()),
+		static_cast<float>(u.Y()), static_cast<float>(-u.X()),
+		rgba[0], rgba[1], rgba[2], rgba[3]};
+	batch.Add(values);
 }
@@ -23,7 +23,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "StellarObject.h"
 #include "System.h"
 
-#include <mutex>
+#include <algorithm>
 
 using namespace std;
 
@@ -65,28 +65,24 @@ namespace {
 	}
 	
 	// Check if the given system is within the given distance of the center.
+	// An unlimited distance map uses the shared routes from that center, so
+	// this does not need to search for a route.
 	int Distance(const System *center, const System *system, int maximum)
 	{
-		// This function should only ever be called from the main thread, but
-		// just to be sure, use mutex protection on the static locals.
-		static mutex distanceMutex;
-		lock_guard<mutex> lock(distanceMutex);
-		
-		static const System *previousCenter = center;
-		static DistanceMap distance(center, -1, maximum);
-		static int previousMaximum = maximum;
-		
-		if(center != previousCenter || maximum > previousMaximum)
-		{
-			previousCenter = center;
-			previousMaximum = maximum;
-			distance = DistanceMap(center, -1, maximum);
-		}
 		// If the distance is greater than the maximum, this is not a match.
-		int d = distance.Days(system);
+		int d = DistanceMap(center).Days(system);
 		return (d > maximum) ? -1 : d;
 	}
 	
+	// Get all the systems within the given distance of the center.
+	void SystemsNear(const System *center, int maximum, vector<const System *> &result)
+	{
+		DistanceMap distance(center);
+		for(const System *system : distance.Systems())
+			if(distance.Days(system) <= maximum)
+				result.push_back(system);
+	}
+	
 	// Check that at least one neighbor of the hub system matches, for each of the neighbor filters.
 	// False if at least one filter fails to match, true if all filters find at least one match.
 	bool MatchesNeighborFilters(const list<LocationFilter> &neighborFilters, const System *hub, const System *origin)
@@ -234,6 +230,35 @@ bool LocationFilter::IsEmpty() const
 
 
 
+// Get the constraints on which planets this filter can match.
+const set<const Planet *> &LocationFilter::Planets() const
+{
+	return planets;
+}
+
+
+
+const set<const System *> &LocationFilter::Systems() const
+{
+	return systems;
+}
+
+
+
+const set<const Government *> &LocationFilter::Governments() const
+{
+	return governments;
+}
+
+
+
+const list<set<string>> &LocationFilter::Attributes() const
+{
+	return attributes;
+}
+
+
+
 // If the player is in the given system, does this filter match?
 bool LocationFilter::Matches(const Planet *planet, const System *origin) const
 {
@@ -365,15 +390,21 @@ LocationFilter LocationFilter::SetOrigin(const System *origin) const
 // Pick a random system that matches this filter, based on the given origin.
 const System *LocationFilter::PickSystem(const System *origin) const
 {
-	// Find a planet that satisfies the filter.
+	// Only check the systems this filter could match, if it narrows them down.
+	vector<const System *> candidates;
+	if(!CandidateSystems(origin, candidates))
+		for(const auto &it : GameData::Systems())
+			candidates.push_back(&it.second);
+	
+	// Find a system that satisfies the filter.
 	vector<const System *> options;
-	for(const auto &it : GameData::Systems())
+	for(const System *system : candidates)
 	{
 		// Skip entries with incomplete data.
-		if(it.second.Name().empty())
+		if(system->Name().empty())
 			continue;
-		if(Matches(&it.second, origin))
-			options.push_back(&it.second);
+		if(Matches(system, origin))
+			options.push_back(system);
 	}
 	return options.empty() ? nullptr : options[Random::Int(options.size())];
 }
@@ -383,19 +414,44 @@ const System *LocationFilter::PickSystem(const System *origin) const
 // Pick a random planet that matches this filter, based on the given origin.
 const Planet *LocationFilter::PickPlanet(const System *origin, bool hasClearance) const
 {
+	// Only check the planets this filter could match: the ones it names, or
+	// the ones in the systems it could match.
+	vector<const Planet *> candidates;
+	vector<const System *> systemCandidates;
+	if(!planets.empty())
+		candidates.assign(planets.begin(), planets.end());
+	else if(CandidateSystems(origin, systemCandidates))
+	{
+		for(const System *system : systemCandidates)
+			for(const StellarObject &object : system->Objects())
+				if(object.GetPlanet() && object.GetPlanet()->GetSystem() == system)
+					candidates.push_back(object.GetPlanet());
+	}
+	else
+		for(const auto &it : GameData::Planets())
+			candidates.push_back(&it.second);
+	
+	// Keep the planets in the same order as in GameData, so that the choice
+	// does not depend on how the candidates were found.
+	if(!planets.empty() || !systemCandidates.empty())
+	{
+		sort(candidates.begin(), candidates.end(),
+			[](const Planet *a, const Planet *b) { return a->TrueName() < b->TrueName(); });
+		candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+	}
+	
 	// Find a planet that satisfies the filter.
 	vector<const Planet *> options;
-	for(const auto &it : GameData::Planets())
+	for(const Planet *planet : candidates)
 	{
-		const Planet &planet = it.second;
 		// Skip entries with incomplete data.
-		if(planet.Name().empty() || !planet.GetSystem())
+		if(planet->Name().empty() || !planet->GetSystem())
 			continue;
 		// Skip planets that do not offer jobs or missions.
-		if(planet.IsWormhole() || !planet.HasSpaceport() || (!hasClearance && !planet.CanLand()))
+		if(planet->IsWormhole() || !planet->HasSpaceport() || (!hasClearance && !planet->CanLand()))
 			continue;
-		if(Matches(&planet, origin))
-			options.push_back(&planet);
+		if(Matches(planet, origin))
+			options.push_back(planet);
 	}
 	return options.empty() ? nullptr : options[Random::Int(options.size())];
 }
@@ -555,3 +611,24 @@ bool LocationFilter::Matches(const System *system, const System *origin, bool di
 	
 	return true;
 }
+
+
+
+// Get the systems that could possibly match this filter.
+bool LocationFilter::CandidateSystems(const System *origin, vector<const System *> &result) const
+{
+	if(!systems.empty())
+		result.assign(systems.begin(), systems.end());
+	else if(center)
+		SystemsNear(center, centerMaxDistance, result);
+	else if(origin && originMaxDistance >= 0)
+		SystemsNear(origin, originMaxDistance, result);
+	else
+		return false;
+	
+	// Keep the systems in the same order as in GameData, so that the choice of
+	// system does not depend on how the candidates were found.
+	sort(result.begin(), result.end(),
+		[](const System *a, const System *b) { return a->Name() < b->Name(); });
+	return true;
+}
@@ -16,6 +16,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include <list>
 #include <set>
 #include <string>
+#include <vector>
 
 class DataNode;
 class DataWriter;
@@ -45,6 +46,14 @@ public:
 	
 	// Check if this filter contains any specifications.
 	bool IsEmpty() const;
+	// Get the constraints on which planets this filter can match. A matching
+	// planet must be one of these planets, be in one of these systems, belong
+	// to one of these governments, and have at least one attribute from each
+	// set of attributes. Any of these that are empty do not restrict matches.
+	const std::set<const Planet *> &Planets() const;
+	const std::set<const System *> &Systems() const;
+	const std::set<const Government *> &Governments() const;
+	const std::list<std::set<std::string>> &Attributes() const;
 	
 	// If the player is in the given system, does this filter match?
 	bool Matches(const Planet *planet, const System *origin = nullptr) const;
@@ -69,6 +78,10 @@ private:
 	// only if the filter wasn't looking for planet characteristics or if the
 	// didPlanet argument is set (meaning we already checked those).
 	bool Matches(const System *system, const System *origin, bool didPlanet) const;
+	// Get the systems that could possibly match this filter, based on the
+	// systems it names and its distance limits. If it does not narrow down the
+	// possible systems at all, return false.
+	bool CandidateSystems(const System *origin, std::vector<const System *> &result) const;
 	
 	
 private:
@@ -33,6 +33,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Planet.h"
 #include "PlayerInfo.h"
 #include "PointerShader.h"
+#include "PrimitiveBatch.h"
 #include "Politics.h"
 #include "Preferences.h"
 #include "RingShader.h"
@@ -980,6 +981,7 @@ void MapPanel::DrawWormholes()
 void MapPanel::DrawLinks()
 {
 	double zoom = Zoom();
+	PrimitiveBatch::Begin();
 	for(const Link &link : links)
 	{
 		Point from = zoom * (link.start + center);
@@ -990,6 +992,7 @@ void MapPanel::DrawLinks()
 		
 		LineShader::Draw(from, to, LINK_WIDTH, link.color);
 	}
+	PrimitiveBatch::End();
 }
 
 
@@ -1007,10 +1010,11 @@ void MapPanel::DrawSystems()
 	
 	// Draw the circles for the systems.
 	double zoom = Zoom();
+	RingShader::Bind();
 	for(const Node &node : nodes)
 	{
 		Point pos = zoom * (node.position + center);
-		RingShader::Draw(pos, OUTER, INNER, node.color);
+		RingShader::Add(pos, OUTER, INNER, node.color);
 		
 		if(commodity == SHOW_GOVERNMENT && node.government && node.government->GetName() != "Uninhabited")
 		{
@@ -1025,6 +1029,7 @@ void MapPanel::DrawSystems()
 				it->second = min(it->second, distance);
 		}
 	}
+	RingShader::Unbind();
 }
 
 
@@ -13,14 +13,73 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Mask.h"
 
 #include "ImageBuffer.h"
+#include "pi.h"
 
 #include <algorithm>
 #include <cmath>
 #include <limits>
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using namespace std;
 
 namespace {
+	// Wrappers for the vector extensions used by the outline kernels, so the
+	// same kernel code works with four doubles (AVX) or two (SSE2) at a time.
+	// Each operation matches the corresponding scalar one exactly, so the
+	// results do not depend on which instructions are available.
+#if defined(__AVX__)
+	typedef __m256d Pack;
+	const int LANES = 4;
+	inline Pack Load(const double *p) { return _mm256_loadu_pd(p); }
+	inline Pack Fill(double value) { return _mm256_set1_pd(value); }
+	inline Pack Add(Pack a, Pack b) { return _mm256_add_pd(a, b); }
+	inline Pack Sub(Pack a, Pack b) { return _mm256_sub_pd(a, b); }
+	inline Pack Mul(Pack a, Pack b) { return _mm256_mul_pd(a, b); }
+	inline Pack Div(Pack a, Pack b) { return _mm256_div_pd(a, b); }
+	inline Pack Min(Pack a, Pack b) { return _mm256_min_pd(a, b); }
+	inline Pack And(Pack a, Pack b) { return _mm256_and_pd(a, b); }
+	inline Pack AndNot(Pack a, Pack b) { return _mm256_andnot_pd(a, b); }
+	inline Pack Or(Pack a, Pack b) { return _mm256_or_pd(a, b); }
+	inline Pack Xor(Pack a, Pack b) { return _mm256_xor_pd(a, b); }
+	inline Pack Less(Pack a, Pack b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+	inline Pack LessEqual(Pack a, Pack b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+	inline Pack NotEqual(Pack a, Pack b) { return _mm256_cmp_pd(a, b, _CMP_NEQ_UQ); }
+	inline int Bits(Pack mask) { return _mm256_movemask_pd(mask); }
+	inline double Smallest(Pack a)
+	{
+		__m128d half = _mm_min_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+		return _mm_cvtsd_f64(_mm_min_sd(half, _mm_unpackhi_pd(half, half)));
+	}
+#elif defined(__SSE2__)
+	typedef __m128d Pack;
+	const int LANES = 2;
+	inline Pack Load(const double *p) { return _mm_loadu_pd(p); }
+	inline Pack Fill(double value) { return _mm_set1_pd(value); }
+	inline Pack Add(Pack a, Pack b) { return _mm_add_pd(a, b); }
+	inline Pack Sub(Pack a, Pack b) { return _mm_sub_pd(a, b); }
+	inline Pack Mul(Pack a, Pack b) { return _mm_mul_pd(a, b); }
+	inline Pack Div(Pack a, Pack b) { return _mm_div_pd(a, b); }
+	inline Pack Min(Pack a, Pack b) { return _mm_min_pd(a, b); }
+	inline Pack And(Pack a, Pack b) { return _mm_and_pd(a, b); }
+	inline Pack AndNot(Pack a, Pack b) { return _mm_andnot_pd(a, b); }
+	inline Pack Or(Pack a, Pack b) { return _mm_or_pd(a, b); }
+	inline Pack Xor(Pack a, Pack b) { return _mm_xor_pd(a, b); }
+	inline Pack Less(Pack a, Pack b) { return _mm_cmplt_pd(a, b); }
+	inline Pack LessEqual(Pack a, Pack b) { return _mm_cmple_pd(a, b); }
+	inline Pack NotEqual(Pack a, Pack b) { return _mm_cmpneq_pd(a, b); }
+	inline int Bits(Pack mask) { return _mm_movemask_pd(mask); }
+	inline double Smallest(Pack a)
+	{
+		return _mm_cvtsd_f64(_mm_min_sd(a, _mm_unpackhi_pd(a, a)));
+	}
+#endif
+	
+	
 	// Trace out a pixmap.
 	void Trace(const ImageBuffer &image, int frame, vector<Point> *raw)
 	{
@@ -230,6 +289,8 @@ void Mask::Create(const ImageBuffer &image, int frame)
 	Simplify(raw, &outline);
 	
 	radius = ComputeRadius(outline);
+	CacheEdges();
+	BuildTree();
 }
 
 
@@ -249,6 +310,17 @@ bool Mask::IsLoaded() const
 // is no collision, the return value is 1.
 double Mask::Collide(Point sA, Point vA, Angle facing) const
 {
+	// If the bounds are cached, check whether the segment's bounding box
+	// overlaps the mask's before doing anything else.
+	if(!bounds.empty())
+	{
+		const Box &box = bounds[facing.Slice(SLICES)];
+		Point end = sA + vA;
+		if(box.maxX < min(sA.X(), end.X()) || box.minX > max(sA.X(), end.X())
+				|| box.maxY < min(sA.Y(), end.Y()) || box.minY > max(sA.Y(), end.Y()))
+			return 1.;
+	}
+	
 	// Bail out if we're too far away to possibly be touching.
 	double distance = sA.Length();
 	if(outline.empty() || distance > radius + vA.Length())
@@ -278,6 +350,12 @@ bool Mask::Contains(Point point, Angle facing) const
 {
 	if(outline.empty() || point.Length() > radius)
 		return false;
+	if(!bounds.empty())
+	{
+		const Box &box = bounds[facing.Slice(SLICES)];
+		if(point.X() < box.minX || point.X() > box.maxX || point.Y() < box.minY || point.Y() > box.maxY)
+			return false;
+	}
 	
 	// Rotate into the mask's frame of reference.
 	return Contains((-facing).Rotate(point));
@@ -292,17 +370,13 @@ bool Mask::WithinRange(Point point, Angle facing, double range) const
 	// Bail out if the object is too far away to possible be touched.
 	if(outline.empty() || range < point.Length() - radius)
 		return false;
+	if(!bounds.empty() && BoxDistanceSquared(bounds[facing.Slice(SLICES)], point) >= range * range)
+		return false;
 	
-	// Rotate into the mask's frame of reference.
-	point = (-facing).Rotate(point);
-	// For efficiency, compare to range^2 instead of range.
+	// Rotate into the mask's frame of reference. For efficiency, compare to
+	// range^2 instead of range.
 	range *= range;
-	
-	for(const Point &p : outline)
-		if(p.DistanceSquared(point) < range)
-			return true;
-	
-	return false;
+	return MinDistanceSquared((-facing).Rotate(point), range) < range;
 }
 
 
@@ -319,10 +393,7 @@ double Mask::Range(Point point, Angle facing) const
 	if(Contains(point))
 		return 0.;
 	
-	for(const Point &p : outline)
-		range = min(range, p.Distance(point));
-	
-	return range;
+	return sqrt(MinDistanceSquared(point, range));
 }
 
 
@@ -342,22 +413,273 @@ const vector<Point> &Mask::Points() const
 
 
 
-double Mask::Intersection(Point sA, Point vA) const
+// Cache the bounding box of the rotated outline for each range of facing
+// angles.
+void Mask::CacheBounds()
 {
-	// Keep track of the closest intersection point found.
-	double closest = 1.;
+	bounds.clear();
+	if(outline.empty())
+		return;
+	
+	// Find the bounding box at the middle angle of each slice, then expand it
+	// by the furthest that any point can move when rotated to the edge of the
+	// slice (plus a little extra for round-off error).
+	const double step = 360. / SLICES;
+	const double pad = radius * (step * .5 * TO_RAD) + 1e-6;
+	bounds.resize(SLICES);
+	for(int i = 0; i < SLICES; ++i)
+	{
+		Angle facing((i + .5) * step);
+		Box &box = bounds[i];
+		box.minX = box.minY = numeric_limits<double>::infinity();
+		box.maxX = box.maxY = -numeric_limits<double>::infinity();
+		for(const Point &point : outline)
+		{
+			Point rotated = facing.Rotate(point);
+			box.minX = min(box.minX, rotated.X());
+			box.minY = min(box.minY, rotated.Y());
+			box.maxX = max(box.maxX, rotated.X());
+			box.maxY = max(box.maxY, rotated.Y());
+		}
+		box.minX -= pad;
+		box.minY -= pad;
+		box.maxX += pad;
+		box.maxY += pad;
+	}
+}
+
+
+
+// Fill in the structure-of-arrays copy of the outline.
+void Mask::CacheEdges()
+{
+	x.clear();
+	y.clear();
+	dx.clear();
+	dy.clear();
+	if(outline.empty())
+		return;
 	
 	Point prev = outline.back();
+	x.push_back(prev.X());
+	y.push_back(prev.Y());
 	for(const Point &next : outline)
+	{
+		Point vB = next - prev;
+		x.push_back(next.X());
+		y.push_back(next.Y());
+		dx.push_back(vB.X());
+		dy.push_back(vB.Y());
+		prev = next;
+	}
+}
+
+
+
+// Build the bounding box hierarchy for large outlines.
+void Mask::BuildTree()
+{
+	tree.clear();
+	const int size = dx.size();
+	if(size > TREE_EDGES)
+		AddNode(0, size);
+}
+
+
+
+// Add a node covering edges [begin, end), followed by all its children. Each
+// node's box contains both end points of every edge in it, padded slightly so
+// that round-off in the edge tests can never land just outside of it.
+void Mask::AddNode(int begin, int end)
+{
+	static const double PAD = 1e-6;
+	
+	int index = tree.size();
+	tree.emplace_back();
+	Node &node = tree.back();
+	node.begin = begin;
+	node.end = end;
+	auto xRange = minmax_element(x.begin() + begin, x.begin() + end + 1);
+	auto yRange = minmax_element(y.begin() + begin, y.begin() + end + 1);
+	node.minX = *xRange.first - PAD;
+	node.maxX = *xRange.second + PAD;
+	node.minY = *yRange.first - PAD;
+	node.maxY = *yRange.second + PAD;
+	
+	// Split the edges in half, keeping the split on a multiple of the SIMD
+	// width so that as few edges as possible are left for the scalar loops.
+	if(end - begin > LEAF_EDGES)
+	{
+		int middle = begin + ((end - begin) / 2 + 3) / 4 * 4;
+		AddNode(begin, middle);
+		AddNode(middle, end);
+	}
+	// Adding the children may have moved the node, so look it up again.
+	tree[index].skip = tree.size();
+}
+
+
+
+double Mask::Intersection(Point sA, Point vA) const
+{
+	if(tree.empty())
+		return Intersection(sA, vA, 0, dx.size(), 1.);
+	
+	// Keep track of the closest intersection point found. Only edges within
+	// the bounding box of the part of the segment before that point can
+	// possibly be any closer, so the search narrows as it goes.
+	double closest = 1.;
+	for(size_t i = 0; i < tree.size(); )
+	{
+		const Node &node = tree[i];
+		Point end = sA + closest * vA;
+		if(node.maxX < min(sA.X(), end.X()) || node.minX > max(sA.X(), end.X())
+				|| node.maxY < min(sA.Y(), end.Y()) || node.minY > max(sA.Y(), end.Y()))
+			i = node.skip;
+		else if(node.end - node.begin > LEAF_EDGES)
+			++i;
+		else
+		{
+			closest = Intersection(sA, vA, node.begin, node.end, closest);
+			i = node.skip;
+		}
+	}
+	return closest;
+}
+
+
+
+bool Mask::Contains(Point point) const
+{
+	// If this point is contained within the mask, a ray drawn out from it will
+	// intersect the mask an even number of times. If that ray coincides with an
+	// edge, ignore that edge, and count all segments as closed at the start and
+	// open at the end to avoid double-counting.
+	
+	// For simplicity, use a ray pointing straight downwards. A segment then
+	// intersects only if its x coordinates span the point's coordinates.
+	if(tree.empty())
+		return (Crossings(point, 0, dx.size()) & 1);
+	
+	// Only edges that span the point's x coordinate and are not entirely
+	// above it can cross that ray.
+	int intersections = 0;
+	for(size_t i = 0; i < tree.size(); )
+	{
+		const Node &node = tree[i];
+		if(node.minX > point.X() || node.maxX < point.X() || node.maxY < point.Y())
+			i = node.skip;
+		else if(node.end - node.begin > LEAF_EDGES)
+			++i;
+		else
+		{
+			intersections += Crossings(point, node.begin, node.end);
+			i = node.skip;
+		}
+	}
+	// If the number of intersections is odd, the point is within the mask.
+	return (intersections & 1);
+}
+
+
+
+// Get the smallest squared distance from the given point to any vertex. If
+// there is no vertex closer than the given limit, the limit is returned.
+double Mask::MinDistanceSquared(Point point, double limit) const
+{
+	if(tree.empty())
+		return MinDistanceSquared(point, 0, dx.size(), limit);
+	
+	// Search the nearer child of each node first, and skip any node whose box
+	// is no closer than the best vertex found so far.
+	double result = limit;
+	int stack[64];
+	double stackDistance[64];
+	int depth = 0;
+	stack[depth] = 0;
+	stackDistance[depth++] = 0.;
+	while(depth)
+	{
+		--depth;
+		if(stackDistance[depth] >= result)
+			continue;
+		const Node &node = tree[stack[depth]];
+		if(node.end - node.begin <= LEAF_EDGES)
+		{
+			result = MinDistanceSquared(point, node.begin, node.end, result);
+			continue;
+		}
+		int first = stack[depth] + 1;
+		int second = tree[first].skip;
+		double firstDistance = BoxDistanceSquared(tree[first], point);
+		double secondDistance = BoxDistanceSquared(tree[second], point);
+		if(firstDistance < secondDistance)
+		{
+			swap(first, second);
+			swap(firstDistance, secondDistance);
+		}
+		stack[depth] = first;
+		stackDistance[depth++] = firstDistance;
+		stack[depth] = second;
+		stackDistance[depth++] = secondDistance;
+	}
+	return result;
+}
+
+
+
+// Get the squared distance from the given point to a bounding box.
+double Mask::BoxDistanceSquared(const Box &box, Point point)
+{
+	double offX = max(0., max(box.minX - point.X(), point.X() - box.maxX));
+	double offY = max(0., max(box.minY - point.Y(), point.Y() - box.maxY));
+	return offX * offX + offY * offY;
+}
+
+
+
+// Find the closest intersection with any of the edges in [begin, end), if it
+// is closer than the given fraction of the segment.
+double Mask::Intersection(Point sA, Point vA, int begin, int end, double closest) const
+{
+	int i = begin;
+#if defined(__AVX__) || defined(__SSE2__)
+	const Pack vAX = Fill(vA.X());
+	const Pack vAY = Fill(vA.Y());
+	const Pack sAX = Fill(sA.X());
+	const Pack sAY = Fill(sA.Y());
+	const Pack zero = Fill(0.);
+	const Pack one = Fill(1.);
+	Pack best = Fill(closest);
+	for( ; i + LANES <= end; i += LANES)
+	{
+		Pack vBX = Load(&dx[i]);
+		Pack vBY = Load(&dy[i]);
+		Pack cross = Sub(Mul(vBX, vAY), Mul(vBY, vAX));
+		Pack vSX = Sub(Load(&x[i]), sAX);
+		Pack vSY = Sub(Load(&y[i]), sAY);
+		Pack uB = Sub(Mul(vAX, vSY), Mul(vAY, vSX));
+		Pack uA = Sub(Mul(vBX, vSY), Mul(vBY, vSX));
+		// Same test as the scalar loop below, for every lane at once.
+		Pack hit = And(And(Less(zero, cross), LessEqual(zero, uB)),
+			And(Less(uB, cross), LessEqual(zero, uA)));
+		if(!Bits(hit))
+			continue;
+		Pack fraction = Div(uA, cross);
+		best = Min(best, Or(And(hit, fraction), AndNot(hit, one)));
+	}
+	closest = Smallest(best);
+#endif
+	for( ; i < end; ++i)
 	{
 		// Check if there is an intersection. (If not, the cross would be 0.) If
 		// there is, handle it only if it is a point where the segment is
 		// entering the polygon rather than exiting it (i.e. cross > 0).
-		Point vB = next - prev;
+		Point vB(dx[i], dy[i]);
 		double cross = vB.Cross(vA);
 		if(cross > 0.)
 		{
-			Point vS = prev - sA;
+			Point vS = Point(x[i], y[i]) - sA;
 			double uB = vA.Cross(vS);
 			double uA = vB.Cross(vS);
 			// If the intersection occurs somewhere within this segment of the
@@ -366,36 +688,74 @@ double Mask::Intersection(Point sA, Point vA) const
 			if((uB >= 0.) & (uB < cross) & (uA >= 0.))
 				closest = min(closest, uA / cross);
 		}
-		
-		prev = next;
 	}
 	return closest;
 }
 
 
 
-bool Mask::Contains(Point point) const
+// Count how many of the edges in [begin, end) cross a ray pointing straight
+// down from the given point.
+int Mask::Crossings(Point point, int begin, int end) const
 {
-	// If this point is contained within the mask, a ray drawn out from it will
-	// intersect the mask an even number of times. If that ray coincides with an
-	// edge, ignore that edge, and count all segments as closed at the start and
-	// open at the end to avoid double-counting.
-	
-	// For simplicity, use a ray pointing straight downwards. A segment then
-	// intersects only if its x coordinates span the point's coordinates.
 	int intersections = 0;
-	Point prev = outline.back();
-	for(const Point &next : outline)
+	int i = begin;
+#if defined(__AVX__) || defined(__SSE2__)
+	const Pack pX = Fill(point.X());
+	const Pack pY = Fill(point.Y());
+	const Pack zero = Fill(0.);
+	for( ; i + LANES <= end; i += LANES)
 	{
-		if(prev.X() != next.X())
-			if((prev.X() <= point.X()) == (point.X() < next.X()))
+		Pack prevX = Load(&x[i]);
+		Pack nextX = Load(&x[i + 1]);
+		Pack vX = Load(&dx[i]);
+		// The edge spans the point if these comparisons agree, i.e. if either
+		// prevX <= x < nextX or nextX <= x < prevX, and it is not vertical.
+		Pack spans = AndNot(Xor(LessEqual(prevX, pX), Less(pX, nextX)), NotEqual(vX, zero));
+		if(!Bits(spans))
+			continue;
+		Pack edgeY = Add(Load(&y[i]), Div(Mul(Load(&dy[i]), Sub(pX, prevX)), vX));
+		int below = Bits(And(spans, LessEqual(pY, edgeY)));
+		for( ; below; below &= below - 1)
+			++intersections;
+	}
+#endif
+	for( ; i < end; ++i)
+	{
+		double prevX = x[i];
+		double nextX = x[i + 1];
+		if(prevX != nextX)
+			if((prevX <= point.X()) == (point.X() < nextX))
 			{
-				double y = prev.Y() + (next.Y() - prev.Y()) *
-					(point.X() - prev.X()) / (next.X() - prev.X());
-				intersections += (y >= point.Y());
+				double edgeY = y[i] + dy[i] * (point.X() - prevX) / dx[i];
+				intersections += (edgeY >= point.Y());
 			}
-		prev = next;
 	}
-	// If the number of intersections is odd, the point is within the mask.
-	return (intersections & 1);
+	return intersections;
+}
+
+
+
+// Get the smallest squared distance from the given point to the end point of
+// any edge in [begin, end), if it is smaller than the given distance.
+double Mask::MinDistanceSquared(Point point, int begin, int end, double result) const
+{
+	// The first entry in the arrays is a copy of the last point, so the end
+	// point of edge i is at index i + 1.
+	int i = begin;
+#if defined(__AVX__) || defined(__SSE2__)
+	const Pack pX = Fill(point.X());
+	const Pack pY = Fill(point.Y());
+	Pack best = Fill(result);
+	for( ; i + LANES <= end; i += LANES)
+	{
+		Pack offX = Sub(Load(&x[i + 1]), pX);
+		Pack offY = Sub(Load(&y[i + 1]), pY);
+		best = Min(best, Add(Mul(offX, offX), Mul(offY, offY)));
+	}
+	result = Smallest(best);
+#endif
+	for( ; i < end; ++i)
+		result = min(result, Point(x[i + 1], y[i + 1]).DistanceSquared(point));
+	return result;
 }
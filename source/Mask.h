@@ -60,15 +60,86 @@ public:
 	// Get the list of points in the outline.
 	const std::vector<Point> &Points() const;
 	
+	// Cache the bounding box of the rotated outline for each range of facing
+	// angles. This takes a few kilobytes per mask, but it lets Collide(),
+	// Contains() and WithinRange() reject most misses without rotating the
+	// query or looking at the outline at all.
+	void CacheBounds();
+	
 	
 private:
+	// Fill in the structure-of-arrays copy of the outline.
+	void CacheEdges();
+	// Build the bounding box hierarchy for large outlines.
+	void BuildTree();
+	void AddNode(int begin, int end);
+	
 	double Intersection(Point sA, Point vA) const;
 	bool Contains(Point point) const;
+	// Get the smallest squared distance from the given point to any vertex,
+	// or the given limit if no vertex is closer than that.
+	double MinDistanceSquared(Point point, double limit) const;
+	
+	// The same tests, applied to the edges in [begin, end) only.
+	double Intersection(Point sA, Point vA, int begin, int end, double closest) const;
+	int Crossings(Point point, int begin, int end) const;
+	double MinDistanceSquared(Point point, int begin, int end, double result) const;
+	
+	
+private:
+	// An axis-aligned bounding box.
+	class Box {
+	public:
+		double minX;
+		double minY;
+		double maxX;
+		double maxY;
+	};
+	
+	// A node in the bounding box hierarchy, covering edges [begin, end). The
+	// nodes are stored in depth-first order, so a node's first child (if it
+	// has any) comes right after it, and skip is the index of the next node
+	// that is not one of its descendants.
+	class Node : public Box {
+	public:
+		int begin;
+		int end;
+		int skip;
+	};
+	
+	// Outlines with more edges than this get a bounding box hierarchy, and
+	// the leaves of that hierarchy have no more than this many edges each.
+	static const int TREE_EDGES = 128;
+	static const int LEAF_EDGES = 32;
+	
+	// Get the squared distance from the given point to a bounding box.
+	static double BoxDistanceSquared(const Box &box, Point point);
+	
+	// The number of facing angle ranges to cache bounding boxes for.
+	static const int SLICES = 64;
 	
 	
 private:
 	std::vector<Point> outline;
 	double radius;
+	
+	// The outline is also stored as separate arrays of coordinates, which lets
+	// the collision tests check several edges at once using vector extensions.
+	// Edge i runs from (x[i], y[i]) to (x[i + 1], y[i + 1]), and (dx[i], dy[i])
+	// is the difference between those two points. The first point is the last
+	// point of the outline, so that the arrays describe a closed loop.
+	std::vector<double> x;
+	std::vector<double> y;
+	std::vector<double> dx;
+	std::vector<double> dy;
+	
+	// Large outlines are also divided into a hierarchy of bounding boxes, so
+	// the tests only need to look at the edges near the point or segment.
+	std::vector<Node> tree;
+	
+	// If cached, the bounding box of the outline rotated to any facing angle
+	// in each slice of the circle, relative to the mask's center.
+	std::vector<Box> bounds;
 };
 
 
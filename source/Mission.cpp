@@ -423,6 +423,22 @@ bool Mission::IsAtLocation(Location location) const
 
 
 
+// Get the planet this mission must be offered on (if any), and the filter
+// that the planet (or ship) it is offered on must match.
+const Planet *Mission::Source() const
+{
+	return source;
+}
+
+
+
+const LocationFilter &Mission::SourceFilter() const
+{
+	return sourceFilter;
+}
+
+
+
 // Information about what you are doing.
 const Planet *Mission::Destination() const
 {
@@ -573,10 +589,10 @@ bool Mission::CanOffer(const PlayerInfo &player, const shared_ptr<Ship> &boardin
 			return false;
 	}
 	
-	if(!toOffer.Test(player.Conditions()))
+	if(!player.Conditions().Test(toOffer))
 		return false;
 	
-	if(!toFail.IsEmpty() && toFail.Test(player.Conditions()))
+	if(!toFail.IsEmpty() && player.Conditions().Test(toFail))
 		return false;
 	
 	if(repeat)
@@ -627,7 +643,7 @@ bool Mission::CanComplete(const PlayerInfo &player) const
 	if(player.GetPlanet() != destination)
 		return false;
 	
-	if(!toComplete.Test(player.Conditions()))
+	if(!player.Conditions().Test(toComplete))
 		return false;
 	
 	return IsSatisfied(player);
@@ -666,7 +682,7 @@ bool Mission::IsSatisfied(const PlayerInfo &player) const
 
 bool Mission::HasFailed(const PlayerInfo &player) const
 {
-	if(!toFail.IsEmpty() && toFail.Test(player.Conditions()))
+	if(!toFail.IsEmpty() && player.Conditions().Test(toFail))
 		return true;
 	
 	for(const NPC &npc : npcs)
@@ -0,0 +1,93 @@
+/* MissionIndex.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "MissionIndex.h"
+
+#include "LocationFilter.h"
+#include "Mission.h"
+#include "Planet.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+	// Add the indices filed under the given key, if any, to the given list.
+	template<class Key>
+	void Append(vector<size_t> &found, const map<Key, vector<size_t>> &index, const Key &key)
+	{
+		auto it = index.find(key);
+		if(it != index.end())
+			found.insert(found.end(), it->second.begin(), it->second.end());
+	}
+}
+
+
+
+// Add a mission to the index. Missions that are offered when boarding or
+// assisting a ship are not included.
+void MissionIndex::Add(const Mission &mission)
+{
+	if(mission.IsAtLocation(Mission::BOARDING) || mission.IsAtLocation(Mission::ASSISTING))
+		return;
+	
+	size_t index = missions.size();
+	missions.push_back(&mission);
+	
+	// A planet only matches the filter if it meets all of its requirements, so
+	// the mission only needs to be filed under one of them.
+	const LocationFilter &filter = mission.SourceFilter();
+	if(mission.Source())
+		byPlanet[mission.Source()].push_back(index);
+	else if(!filter.Planets().empty())
+		for(const Planet *planet : filter.Planets())
+			byPlanet[planet].push_back(index);
+	else if(!filter.Systems().empty())
+		for(const System *system : filter.Systems())
+			bySystem[system].push_back(index);
+	else if(!filter.Governments().empty())
+		for(const Government *government : filter.Governments())
+			byGovernment[government].push_back(index);
+	else if(!filter.Attributes().empty())
+		for(const string &attribute : filter.Attributes().front())
+			byAttribute[attribute].push_back(index);
+	else
+		unfiled.push_back(index);
+}
+
+
+
+// Get the missions that might be offered on the given planet, in the same
+// order in which they were added.
+vector<const Mission *> MissionIndex::Find(const Planet *planet) const
+{
+	vector<const Mission *> result;
+	// No mission can be offered if the player is not on a planet.
+	if(!planet)
+		return result;
+	
+	vector<size_t> found = unfiled;
+	Append(found, byPlanet, planet);
+	Append(found, bySystem, planet->GetSystem());
+	Append(found, byGovernment, planet->GetGovernment());
+	for(const string &attribute : planet->Attributes())
+		Append(found, byAttribute, attribute);
+	
+	// A mission may be filed under more than one of the planet's attributes.
+	sort(found.begin(), found.end());
+	found.erase(unique(found.begin(), found.end()), found.end());
+	
+	result.reserve(found.size());
+	for(size_t index : found)
+		result.push_back(missions[index]);
+	return result;
+}
@@ -0,0 +1,61 @@
+/* MissionIndex.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef MISSION_INDEX_H_
+#define MISSION_INDEX_H_
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+class Government;
+class Mission;
+class Planet;
+class System;
+
+
+
+// Class that sorts missions by where they can be offered, so that when the
+// player lands, only the missions that might be offered on that planet need to
+// be checked. Each mission is filed under the most specific thing that its
+// offer location requires the planet to be or to have: a particular planet, a
+// system, a government, or one of a set of attributes. Those requirements
+// never change once the missions are loaded, but which system, government, and
+// attributes each planet has can change, so those are looked up when searching.
+class MissionIndex {
+public:
+	// Add a mission to the index. Missions that are offered when boarding or
+	// assisting a ship are not included.
+	void Add(const Mission &mission);
+	
+	// Get the missions that might be offered on the given planet, in the same
+	// order in which they were added. Each one must still be checked with
+	// Mission::CanOffer().
+	std::vector<const Mission *> Find(const Planet *planet) const;
+	
+	
+private:
+	// All the missions in the index, in the order they were added.
+	std::vector<const Mission *> missions;
+	// The indices in that list of the missions filed under each requirement,
+	// and of the missions that must always be checked.
+	std::map<const Planet *, std::vector<size_t>> byPlanet;
+	std::map<const System *, std::vector<size_t>> bySystem;
+	std::map<const Government *, std::vector<size_t>> byGovernment;
+	std::map<std::string, std::vector<size_t>> byAttribute;
+	std::vector<size_t> unfiled;
+};
+
+
+
+#endif
@@ -594,6 +594,9 @@ Point MissionPanel::DrawList(const list<Mission> &list, Point pos) const
 	const Color &selected = *GameData::Colors().Get("bright");
 	const Color &dim = *GameData::Colors().Get("dim");
 	
+	// The highlight is drawn under the text, so all the text can be drawn at
+	// once at the end.
+	Font::BeginBatch();
 	for(auto it = list.begin(); it != list.end(); ++it)
 	{
 		if(!it->IsVisible())
@@ -612,6 +615,7 @@ Point MissionPanel::DrawList(const list<Mission> &list, Point pos) const
 		font.Draw(it->Name(), pos,
 			(!canAccept ? dim : isSelected ? selected : unselected));
 	}
+	Font::EndBatch();
 	
 	return pos;
 }
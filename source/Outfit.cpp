@@ -182,6 +182,13 @@ double Outfit::Get(const string &attribute) const
 
 
 
+double Outfit::Get(const Dictionary::Key &attribute) const
+{
+	return attributes.Get(attribute);
+}
+
+
+
 const Dictionary &Outfit::Attributes() const
 {
 	return attributes;
@@ -59,6 +59,7 @@ public:
 	
 	double Get(const char *attribute) const;
 	double Get(const std::string &attribute) const;
+	double Get(const Dictionary::Key &attribute) const;
 	const Dictionary &Attributes() const;
 	
 	// Determine whether the given number of instances of the given outfit can
@@ -28,6 +28,8 @@ namespace {
 	GLint positionI;
 	GLint frameI;
 	GLint frameCountI;
+	GLint rectI;
+	GLint gridI;
 	GLint colorI;
 	
 	GLuint vao;
@@ -69,29 +71,44 @@ void OutlineShader::Init()
 		"uniform float frameCount = 0;\n"
 		"uniform vec4 color = vec4(1, 1, 1, 1);\n"
 		"uniform vec2 off;\n"
+		"uniform vec4 rect = vec4(0, 0, 1, 1);\n"
+		"uniform vec3 grid = vec3(0, 0, 0);\n"
 		"const vec4 weight = vec4(.4, .4, .4, 1.);\n"
 		
 		"in vec2 fragTexCoord;\n"
 		
 		"out vec4 finalColor;\n"
 		
-		"float Sobel(float layer) {\n"
+		// Small sprites are packed into an atlas, so the frames are rectangles
+		// within the texture rather than separate layers.
+		"vec3 Corner(float frame) {\n"
+		"  if(grid.x == 0)\n"
+		"    return vec3(rect.xy, frame);\n"
+		"  float row = floor((frame + .5) / grid.x);\n"
+		"  return vec3(rect.xy + vec2(frame - row * grid.x, row) * grid.yz, 0);\n"
+		"}\n"
+		
+		"float Sample(vec2 coord, vec3 corner) {\n"
+		"  return dot(texture(tex, vec3(corner.xy + clamp(coord, 0., 1.) * rect.zw, corner.z)), weight);\n"
+		"}\n"
+		
+		"float Sobel(vec3 corner) {\n"
 		"  float sum = 0;\n"
 		"  for(int dy = -1; dy <= 1; ++dy)\n"
 		"  {\n"
 		"    for(int dx = -1; dx <= 1; ++dx)\n"
 		"    {\n"
 		"      vec2 center = fragTexCoord + .618034 * off * vec2(dx, dy);\n"
-		"      float nw = dot(texture(tex, vec3(center + vec2(-off.x, -off.y), layer)), weight);\n"
-		"      float ne = dot(texture(tex, vec3(center + vec2(off.x, -off.y), layer)), weight);\n"
-		"      float sw = dot(texture(tex, vec3(center + vec2(-off.x, off.y), layer)), weight);\n"
-		"      float se = dot(texture(tex, vec3(center + vec2(off.x, off.y), layer)), weight);\n"
+		"      float nw = Sample(center + vec2(-off.x, -off.y), corner);\n"
+		"      float ne = Sample(center + vec2(off.x, -off.y), corner);\n"
+		"      float sw = Sample(center + vec2(-off.x, off.y), corner);\n"
+		"      float se = Sample(center + vec2(off.x, off.y), corner);\n"
 		"      float h = nw + sw - ne - se + 2 * (\n"
-		"        dot(texture(tex, vec3(center + vec2(-off.x, 0), layer)), weight)\n"
-		"          - dot(texture(tex, vec3(center + vec2(off.x, 0), layer)), weight));\n"
+		"        Sample(center + vec2(-off.x, 0), corner)\n"
+		"          - Sample(center + vec2(off.x, 0), corner));\n"
 		"      float v = nw + ne - sw - se + 2 * (\n"
-		"        dot(texture(tex, vec3(center + vec2(0, -off.y), layer)), weight)\n"
-		"          - dot(texture(tex, vec3(center + vec2(0, off.y), layer)), weight));\n"
+		"        Sample(center + vec2(0, -off.y), corner)\n"
+		"          - Sample(center + vec2(0, off.y), corner));\n"
 		"      sum += h * h + v * v;\n"
 		"    }\n"
 		"  }\n"
@@ -102,7 +119,7 @@ void OutlineShader::Init()
 		"  float first = floor(frame);\n"
 		"  float second = mod(ceil(frame), frameCount);\n"
 		"  float fade = frame - first;\n"
-		"  float sum = mix(Sobel(first), Sobel(second), fade);\n"
+		"  float sum = mix(Sobel(Corner(first)), Sobel(Corner(second)), fade);\n"
 		"  finalColor = color * sqrt(sum / 180);\n"
 		"}\n";
 	
@@ -113,6 +130,8 @@ void OutlineShader::Init()
 	positionI = shader.Uniform("position");
 	frameI = shader.Uniform("frame");
 	frameCountI = shader.Uniform("frameCount");
+	rectI = shader.Uniform("rect");
+	gridI = shader.Uniform("grid");
 	colorI = shader.Uniform("color");
 	
 	glUseProgram(shader.Object());
@@ -180,7 +199,13 @@ void OutlineShader::Draw(const Sprite *sprite, const Point &pos, const Point &si
 	
 	glUniform4fv(colorI, 1, color.Get());
 	
-	glBindTexture(GL_TEXTURE_2D_ARRAY, sprite->Texture(unit.Length() * Screen::Zoom() > 50.));
+	bool isHighDPI = (unit.Length() * Screen::Zoom() > 50.);
+	const Sprite::Layout *layout;
+	uint32_t texture = sprite->Texture(isHighDPI, layout);
+	glUniform4fv(rectI, 1, layout->rect);
+	glUniform3fv(gridI, 1, layout->grid);
+	
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
 	
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 	
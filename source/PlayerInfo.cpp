@@ -1393,6 +1393,22 @@ const Mission *PlayerInfo::ActiveBoardingMission() const
 
 
 
+// Find out how many missions were checked the last time the player landed,
+// and how many of those could be offered.
+int PlayerInfo::MissionsTested() const
+{
+	return missionsTested;
+}
+
+
+
+int PlayerInfo::MissionsOffered() const
+{
+	return missionsOffered;
+}
+
+
+
 // Accept the given job.
 void PlayerInfo::AcceptJob(const Mission &mission, UI *ui)
 {
@@ -1628,7 +1644,7 @@ int64_t PlayerInfo::GetCondition(const string &name) const
 
 
 // Get mutable access to the player's list of conditions.
-map<string, int64_t> &PlayerInfo::Conditions()
+ConditionsStore &PlayerInfo::Conditions()
 {
 	return conditions;
 }
@@ -1636,7 +1652,7 @@ map<string, int64_t> &PlayerInfo::Conditions()
 
 
 // Access the player's list of conditions.
-const map<string, int64_t> &PlayerInfo::Conditions() const
+const ConditionsStore &PlayerInfo::Conditions() const
 {
 	return conditions;
 }
@@ -2270,25 +2286,28 @@ void PlayerInfo::CreateMissions()
 {
 	boardingMissions.clear();
 	
-	// Check for available missions.
+	// Check for available missions. Only the missions whose offer location
+	// could possibly match this planet need to be checked.
 	bool skipJobs = planet && !planet->HasSpaceport();
 	bool hasPriorityMissions = false;
-	for(const auto &it : GameData::Missions())
+	missionsTested = 0;
+	missionsOffered = 0;
+	for(const Mission *mission : GameData::MissionsAt(planet))
 	{
-		if(it.second.IsAtLocation(Mission::BOARDING) || it.second.IsAtLocation(Mission::ASSISTING))
-			continue;
-		if(skipJobs && it.second.IsAtLocation(Mission::JOB))
+		if(skipJobs && mission->IsAtLocation(Mission::JOB))
 			continue;
 		
-		if(it.second.CanOffer(*this))
+		++missionsTested;
+		if(mission->CanOffer(*this))
 		{
+			++missionsOffered;
 			list<Mission> &missions =
-				it.second.IsAtLocation(Mission::JOB) ? availableJobs : availableMissions;
+				mission->IsAtLocation(Mission::JOB) ? availableJobs : availableMissions;
 			
-			missions.push_back(it.second.Instantiate(*this));
+			missions.push_back(mission->Instantiate(*this));
 			if(missions.back().HasFailed(*this))
 				missions.pop_back();
-			else if(!it.second.IsAtLocation(Mission::JOB))
+			else if(!mission->IsAtLocation(Mission::JOB))
 				hasPriorityMissions |= missions.back().HasPriority();
 		}
 	}
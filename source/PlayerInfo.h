@@ -15,6 +15,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Account.h"
 #include "CargoHold.h"
+#include "ConditionsStore.h"
 #include "DataNode.h"
 #include "Date.h"
 #include "Depreciation.h"
@@ -152,6 +153,10 @@ public:
 	const std::list<Mission> &Missions() const;
 	const std::list<Mission> &AvailableJobs() const;
 	const Mission *ActiveBoardingMission() const;
+	// Find out how many missions were checked the last time the player landed,
+	// and how many of those could be offered.
+	int MissionsTested() const;
+	int MissionsOffered() const;
 	void AcceptJob(const Mission &mission, UI *ui);
 	// Check to see if there is any mission to offer right now.
 	Mission *MissionToOffer(Mission::Location location);
@@ -174,8 +179,8 @@ public:
 	
 	// Access the "condition" flags for this player.
 	int64_t GetCondition(const std::string &name) const;
-	std::map<std::string, int64_t> &Conditions();
-	const std::map<std::string, int64_t> &Conditions() const;
+	ConditionsStore &Conditions();
+	const ConditionsStore &Conditions() const;
 	// Set and check the reputation conditions, which missions and events
 	// can use to modify the player's reputation with other governments.
 	void SetReputationConditions();
@@ -303,8 +308,10 @@ private:
 	// This pointer to the most recently accepted boarding mission enables
 	// its NPCs to be placed before the player lands, and is then cleared.
 	Mission *activeBoardingMission = nullptr;
+	int missionsTested = 0;
+	int missionsOffered = 0;
 	
-	std::map<std::string, int64_t> conditions;
+	ConditionsStore conditions;
 	
 	std::set<const System *> seen;
 	std::set<const System *> visitedSystems;
@@ -14,7 +14,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Color.h"
 #include "Point.h"
-#include "Screen.h"
+#include "PrimitiveBatch.h"
 #include "Shader.h"
 
 #include <stdexcept>
@@ -23,15 +23,7 @@ using namespace std;
 
 namespace {
 	Shader shader;
-	GLint scaleI;
-	GLint centerI;
-	GLint angleI;
-	GLint sizeI;
-	GLint offsetI;
-	GLint colorI;
-	
-	GLuint vao;
-	GLuint vbo;
+	PrimitiveBatch batch;
 }
 
 
@@ -40,15 +32,20 @@ void PointerShader::Init()
 {
 	static const char *vertexCode =
 		"uniform vec2 scale;\n"
-		"uniform vec2 center;\n"
-		"uniform vec2 angle;\n"
-		"uniform vec2 size;\n"
-		"uniform float offset;\n"
 		
 		"in vec2 vert;\n"
+		"in vec2 center;\n"
+		"in vec2 angle;\n"
+		"in vec2 size;\n"
+		"in float offset;\n"
+		"in vec4 color;\n"
 		"out vec2 coord;\n"
+		"flat out float width;\n"
+		"flat out vec4 fragColor;\n"
 		
 		"void main() {\n"
+		"  width = size.x;\n"
+		"  fragColor = color;\n"
 		"  coord = vert * size.x;\n"
 		"  vec2 base = center + angle * (offset - size.y * (vert.x + vert.y));\n"
 		"  vec2 wing = vec2(angle.y, -angle.x) * (size.x * .5 * (vert.x - vert.y));\n"
@@ -56,49 +53,29 @@ void PointerShader::Init()
 		"}\n";
 
 	static const char *fragmentCode =
-		"uniform vec4 color = vec4(1, 1, 1, 1);\n"
-		"uniform vec2 size;\n"
-		
 		"in vec2 coord;\n"
+		"flat in float width;\n"
+		"flat in vec4 fragColor;\n"
 		"out vec4 finalColor;\n"
 		
 		"void main() {\n"
-		"  float height = (coord.x + coord.y) / size.x;\n"
+		"  float height = (coord.x + coord.y) / width;\n"
 		"  float taper = height * height * height;\n"
-		"  taper *= taper * .5 * size.x;\n"
+		"  taper *= taper * .5 * width;\n"
 		"  float alpha = clamp(.8 * min(coord.x, coord.y) - taper, 0, 1);\n"
 		"  alpha *= clamp(1.8 * (1. - height), 0, 1);\n"
-		"  finalColor = color * alpha;\n"
+		"  finalColor = fragColor * alpha;\n"
 		"}\n";
 	
 	shader = Shader(vertexCode, fragmentCode);
-	scaleI = shader.Uniform("scale");
-	centerI = shader.Uniform("center");
-	angleI = shader.Uniform("angle");
-	sizeI = shader.Uniform("size");
-	offsetI = shader.Uniform("offset");
-	colorI = shader.Uniform("color");
-	
-	// Generate the vertex data for drawing sprites.
-	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
 	
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	
-	GLfloat vertexData[] = {
+	// Generate the vertex data for drawing pointers.
+	static const GLfloat vertexData[] = {
 		0.f, 0.f,
 		0.f, 1.f,
 		1.f, 0.f,
 	};
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertexData), vertexData, GL_STATIC_DRAW);
-	
-	glEnableVertexAttribArray(shader.Attrib("vert"));
-	glVertexAttribPointer(shader.Attrib("vert"), 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
-	
-	// unbind the VBO and VAO
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	batch.Init(shader, vertexData, 3, GL_TRIANGLES, {{"center", 2}, {"angle", 2}, {"size", 2}, {"offset", 1}, {"color", 4}});
 }
 
 
@@ -119,37 +96,26 @@ void PointerShader::Bind()
 	if(!shader.Object())
 		throw runtime_error("PointerShader: Bind() called before Init().");
 	
-	glUseProgram(shader.Object());
-	glBindVertexArray(vao);
-	
-	GLfloat scale[2] = {2.f / Screen::Width(), -2.f / Screen::Height()};
-	glUniform2fv(scaleI, 1, scale);
+	PrimitiveBatch::Begin();
 }
 
 
 
 void PointerShader::Add(const Point &center, const Point &angle, float width, float height, float offset, const Color &color)
 {
-	GLfloat c[2] = {static_cast<float>(center.X()), static_cast<float>(center.Y())};
-	glUniform2fv(centerI, 1, c);
-	
-	GLfloat a[2] = {static_cast<float>(angle.X()), static_cast<float>(angle.Y())};
-	glUniform2fv(angleI, 1, a);
-	
-	GLfloat size[2] = {width, height};
-	glUniform2fv(sizeI, 1, size);
-	
-	glUniform1f(offsetI, offset);
-	
-	glUniform4fv(colorI, 1, color.Get());
-	
-	glDrawArrays(GL_TRIANGLES, 0, 3);
+	const float *rgba = color.Get();
+	GLfloat values[11] = {
+		static_cast<float>(center.X()), static_cast<float>(center.Y()),
+		static_cast<float>(angle.X()), static_cast<float>(angle.Y()),
+		width, height,
+		offset,
+		rgba[0], rgba[1], rgba[2], rgba[3]};
+	batch.Add(values);
 }
 
 
 
 void PointerShader::Unbind()
 {
-	glBindVertexArray(0);
-	glUseProgram(0);
+	PrimitiveBatch::End();
 }
@@ -27,6 +27,7 @@ using namespace std;
 namespace {
 	map<string, bool> settings;
 	int scrollSpeed = 60;
+	int textureMemory = 256;
 	
 	// Strings for ammo expenditure:
 	const string EXPEND_AMMO = "Escorts expend ammo";
@@ -68,6 +69,8 @@ void Preferences::Load()
 			Audio::SetVolume(node.Value(1) * VOLUME_SCALE);
 		else if(node.Token(0) == "scroll speed" && node.Size() >= 2)
 			scrollSpeed = node.Value(1);
+		else if(node.Token(0) == "texture memory" && node.Size() >= 2)
+			textureMemory = node.Value(1);
 		else if(node.Token(0) == "view zoom")
 			zoomIndex = node.Value(1);
 		else
@@ -85,6 +88,7 @@ void Preferences::Save()
 	out.Write("window size", Screen::RawWidth(), Screen::RawHeight());
 	out.Write("zoom", Screen::UserZoom());
 	out.Write("scroll speed", scrollSpeed);
+	out.Write("texture memory", textureMemory);
 	out.Write("view zoom", zoomIndex);
 	
 	for(const auto &it : settings)
@@ -140,6 +144,21 @@ void Preferences::SetScrollSpeed(int speed)
 
 
 
+// Texture memory budget, in megabytes.
+int Preferences::TextureMemory()
+{
+	return textureMemory;
+}
+
+
+
+void Preferences::SetTextureMemory(int megabytes)
+{
+	textureMemory = megabytes;
+}
+
+
+
 // View zoom.
 double Preferences::ViewZoom()
 {
@@ -34,6 +34,11 @@ public:
 	static int ScrollSpeed();
 	static void SetScrollSpeed(int speed);
 	
+	// How much texture memory sprites may use, in megabytes, before the ones
+	// that have not been drawn recently are unloaded.
+	static int TextureMemory();
+	static void SetTextureMemory(int megabytes);
+	
 	// View zoom.
 	static double ViewZoom();
 	static bool ZoomViewIn();
@@ -51,6 +51,7 @@ namespace {
 	const string FRUGAL_ESCORTS = "Escorts use ammo frugally";
 	const string REACTIVATE_HELP = "Reactivate first-time help";
 	const string SCROLL_SPEED = "Scroll speed";
+	const string TEXTURE_MEMORY = "Texture memory";
 	const string FIGHTER_REPAIR = "Repair fighters in";
 }
 
@@ -184,6 +185,14 @@ bool PreferencesPanel::Click(int x, int y, int clicks)
 					speed = 20;
 				Preferences::SetScrollSpeed(speed);
 			}
+			else if(zone.Value() == TEXTURE_MEMORY)
+			{
+				// Toggle between budgets from 128 MB to 1 GB.
+				int megabytes = Preferences::TextureMemory() * 2;
+				if(megabytes > 1024)
+					megabytes = 128;
+				Preferences::SetTextureMemory(megabytes);
+			}
 			else
 				Preferences::Set(zone.Value(), !Preferences::Has(zone.Value()));
 			break;
@@ -264,6 +273,15 @@ bool PreferencesPanel::Scroll(double dx, double dy)
 			speed = min(60, speed + 20);
 		Preferences::SetScrollSpeed(speed);
 	}
+	else if(hoverPreference == TEXTURE_MEMORY)
+	{
+		int megabytes = Preferences::TextureMemory();
+		if(dy < 0.)
+			megabytes = max(128, megabytes / 2);
+		else
+			megabytes = min(1024, megabytes * 2);
+		Preferences::SetTextureMemory(megabytes);
+	}
 	return true;
 }
 
@@ -436,8 +454,12 @@ void PreferencesPanel::DrawSettings()
 		"Show CPU / GPU load",
 		"Render motion blur",
 		"Reduce large graphics",
+		TEXTURE_MEMORY,
+		"Compress graphics",
+		"Cache decoded graphics",
 		"Draw background haze",
 		"Show hyperspace flash",
+		"Parallel simulation",
 		"",
 		"Other",
 		"Clickable radar display",
@@ -536,6 +558,11 @@ void PreferencesPanel::DrawSettings()
 			isOn = true;
 			text = to_string(Preferences::ScrollSpeed());
 		}
+		else if(setting == TEXTURE_MEMORY)
+		{
+			isOn = true;
+			text = to_string(Preferences::TextureMemory()) + " MB";
+		}
 		else
 			text = isOn ? "on" : "off";
 		
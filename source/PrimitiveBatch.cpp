@@ -0,0 +1,181 @@
+/* PrimitiveBatch.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "PrimitiveBatch.h"
+
+#include "Screen.h"
+#include "Shader.h"
+
+using namespace std;
+
+namespace {
+	// Nesting depth of the currently open batch, and the batch (if any) that
+	// has shapes queued up in it.
+	int depth = 0;
+	PrimitiveBatch *pending = nullptr;
+	
+	// Set a constant value for an attribute that is not read from an array.
+	void SetAttribute(GLint attribute, GLint size, const GLfloat *value)
+	{
+		if(size == 1)
+			glVertexAttrib1fv(attribute, value);
+		else if(size == 2)
+			glVertexAttrib2fv(attribute, value);
+		else if(size == 3)
+			glVertexAttrib3fv(attribute, value);
+		else
+			glVertexAttrib4fv(attribute, value);
+	}
+}
+
+
+
+void PrimitiveBatch::Begin()
+{
+	++depth;
+}
+
+
+
+void PrimitiveBatch::End()
+{
+	if(!depth || --depth)
+		return;
+	
+	if(pending)
+		pending->Flush();
+}
+
+
+
+// Set up the vertex data for the given shader.
+void PrimitiveBatch::Init(const Shader &shader, const GLfloat *vertices, GLsizei vertexCount, GLenum mode,
+	const vector<pair<const char *, GLint>> &attributes)
+{
+	this->shader = &shader;
+	this->mode = mode;
+	this->vertexCount = vertexCount;
+	scaleI = shader.Uniform("scale");
+	
+	stride = 0;
+	for(const pair<const char *, GLint> &it : attributes)
+	{
+		this->attributes.push_back(shader.Attrib(it.first));
+		sizes.push_back(it.second);
+		stride += it.second;
+	}
+	
+	// Generate the vertex data for drawing a single shape.
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+	
+	glGenBuffers(1, &vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, 2 * sizeof(GLfloat) * vertexCount, vertices, GL_STATIC_DRAW);
+	
+	glEnableVertexAttribArray(shader.Attrib("vert"));
+	glVertexAttribPointer(shader.Attrib("vert"), 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
+	
+	// Instanced drawing needs glVertexAttribDivisor(), which is only in core
+	// OpenGL as of version 3.3. Without it, batches are drawn one by one.
+#ifdef __APPLE__
+	bool useInstancing = true;
+#else
+	bool useInstancing = GLEW_VERSION_3_3;
+#endif
+	if(useInstancing)
+	{
+		// The second vertex array shares the shape's vertices, but reads all
+		// the other attributes once per instance from the instance buffer.
+		glGenVertexArrays(1, &instanceVao);
+		glBindVertexArray(instanceVao);
+		
+		glEnableVertexAttribArray(shader.Attrib("vert"));
+		glVertexAttribPointer(shader.Attrib("vert"), 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
+		
+		glGenBuffers(1, &instanceVbo);
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+		
+		size_t offset = 0;
+		for(size_t i = 0; i < this->attributes.size(); ++i)
+		{
+			glEnableVertexAttribArray(this->attributes[i]);
+			glVertexAttribPointer(this->attributes[i], sizes[i], GL_FLOAT, GL_FALSE,
+				stride * sizeof(GLfloat), reinterpret_cast<const GLvoid *>(offset * sizeof(GLfloat)));
+			glVertexAttribDivisor(this->attributes[i], 1);
+			offset += sizes[i];
+		}
+	}
+	
+	// unbind the VBO and VAO
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+
+
+// Add a shape, given the values of all its attributes, in order.
+void PrimitiveBatch::Add(const GLfloat *values)
+{
+	// To keep everything in order, draw any other kind of shape that is queued
+	// up before queueing this one.
+	if(pending && pending != this)
+		pending->Flush();
+	pending = this;
+	
+	data.insert(data.end(), values, values + stride);
+	if(!depth)
+		Flush();
+}
+
+
+
+// Draw all the shapes that are queued up.
+void PrimitiveBatch::Flush()
+{
+	if(pending == this)
+		pending = nullptr;
+	if(data.empty())
+		return;
+	
+	glUseProgram(shader->Object());
+	
+	GLfloat scale[2] = {2.f / Screen::Width(), -2.f / Screen::Height()};
+	glUniform2fv(scaleI, 1, scale);
+	
+	size_t count = data.size() / stride;
+	if(count == 1 || !instanceVao)
+	{
+		glBindVertexArray(vao);
+		for(const GLfloat *it = data.data(); it != data.data() + data.size(); )
+		{
+			for(size_t i = 0; i < attributes.size(); ++i)
+			{
+				SetAttribute(attributes[i], sizes[i], it);
+				it += sizes[i];
+			}
+			glDrawArrays(mode, 0, vertexCount);
+		}
+	}
+	else
+	{
+		glBindVertexArray(instanceVao);
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * data.size(), data.data(), GL_STREAM_DRAW);
+		glDrawArraysInstanced(mode, 0, vertexCount, count);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	data.clear();
+	
+	glBindVertexArray(0);
+	glUseProgram(0);
+}
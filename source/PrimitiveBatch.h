@@ -0,0 +1,80 @@
+/* PrimitiveBatch.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef PRIMITIVE_BATCH_H_
+#define PRIMITIVE_BATCH_H_
+
+#include "gl_header.h"
+
+#include <utility>
+#include <vector>
+
+class Shader;
+
+
+
+// Class for drawing many copies of one of the simple shapes (fills, lines,
+// rings, and pointers) with a single draw call. Each shape is described by a
+// fixed list of floats, which its shader reads as per-instance attributes.
+// Outside of a batch, each shape is drawn as soon as it is added. Inside of a
+// batch, consecutive shapes of the same kind are queued up and drawn together
+// when a different kind of shape is added or when the batch ends, so the shapes
+// are still drawn in order. Anything else drawn in the meantime (sprites or
+// text) will end up underneath the queued shapes, though.
+class PrimitiveBatch {
+public:
+	// Begin or end a batch. Batches may be nested; the queued shapes are drawn
+	// when the outermost one ends.
+	static void Begin();
+	static void End();
+	
+	
+public:
+	// Set up the vertex data for the given shader. Every shape is drawn from
+	// the given vertices, each of which is an (x, y) "vert" attribute. The
+	// per-instance attributes are all floats, and are given by name and size.
+	void Init(const Shader &shader, const GLfloat *vertices, GLsizei vertexCount, GLenum mode,
+		const std::vector<std::pair<const char *, GLint>> &attributes);
+	
+	// Add a shape, given the values of all its attributes, in order.
+	void Add(const GLfloat *values);
+	
+	
+private:
+	// Draw all the shapes that are queued up.
+	void Flush();
+	
+	
+private:
+	const Shader *shader = nullptr;
+	GLint scaleI = 0;
+	GLenum mode = GL_TRIANGLE_STRIP;
+	GLsizei vertexCount = 0;
+	
+	// One vertex array is for drawing single shapes, using constant attribute
+	// values, and the other reads the attributes from the instance buffer.
+	GLuint vao = 0;
+	GLuint vbo = 0;
+	GLuint instanceVao = 0;
+	GLuint instanceVbo = 0;
+	
+	std::vector<GLint> attributes;
+	std::vector<GLint> sizes;
+	GLsizei stride = 0;
+	
+	// Attribute values of the queued shapes.
+	std::vector<GLfloat> data;
+};
+
+
+
+#endif
@@ -15,6 +15,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "GameData.h"
 #include "LineShader.h"
 #include "PointerShader.h"
+#include "PrimitiveBatch.h"
 #include "RingShader.h"
 
 #include <cmath>
@@ -83,6 +84,9 @@ void Radar::AddViewportBoundary(const Point &vertex)
 // Draw the radar display at the given coordinates.
 void Radar::Draw(const Point &center, double scale, double radius, double pointerRadius) const
 {
+	// Each kind of shape is drawn with a single draw call.
+	PrimitiveBatch::Begin();
+	
 	// Draw any desired line vectors.
 	for(const Line &line : lines)
 	{
@@ -126,6 +130,8 @@ void Radar::Draw(const Point &center, double scale, double radius, double pointe
 	for(const Pointer &pointer : pointers)
 		PointerShader::Add(center, pointer.unit, 10.f, 10.f, pointerRadius, pointer.color);
 	PointerShader::Unbind();
+	
+	PrimitiveBatch::End();
 }
 
 
@@ -15,7 +15,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Color.h"
 #include "pi.h"
 #include "Point.h"
-#include "Screen.h"
+#include "PrimitiveBatch.h"
 #include "Shader.h"
 
 #include <stdexcept>
@@ -24,17 +24,7 @@ using namespace std;
 
 namespace {
 	Shader shader;
-	GLint scaleI;
-	GLint positionI;
-	GLint radiusI;
-	GLint widthI;
-	GLint angleI;
-	GLint startAngleI;
-	GLint dashI;
-	GLint colorI;
-	
-	GLuint vao;
-	GLuint vbo;
+	PrimitiveBatch batch;
 }
 
 
@@ -43,31 +33,42 @@ void RingShader::Init()
 {
 	static const char *vertexCode =
 		"uniform vec2 scale;\n"
-		"uniform vec2 position;\n"
-		"uniform float radius;\n"
-		"uniform float width;\n"
 		
 		"in vec2 vert;\n"
+		"in vec2 position;\n"
+		// The radius and width of the ring.
+		"in vec2 size;\n"
+		// The angle the ring covers, its start angle, and its dash size.
+		"in vec3 arc;\n"
+		"in vec4 color;\n"
 		"out vec2 coord;\n"
+		"flat out vec2 fragSize;\n"
+		"flat out vec3 fragArc;\n"
+		"flat out vec4 fragColor;\n"
 		
 		"void main() {\n"
-		"  coord = (radius + width) * vert;\n"
+		"  fragSize = size;\n"
+		"  fragArc = arc;\n"
+		"  fragColor = color;\n"
+		"  coord = (size.x + size.y) * vert;\n"
 		"  gl_Position = vec4((coord + position) * scale, 0, 1);\n"
 		"}\n";
 
 	static const char *fragmentCode =
-		"uniform vec4 color = vec4(1, 1, 1, 1);\n"
-		"uniform float radius;\n"
-		"uniform float width;\n"
-		"uniform float angle;\n"
-		"uniform float startAngle;\n"
-		"uniform float dash;\n"
 		"const float pi = 3.1415926535897932384626433832795;\n"
 		
 		"in vec2 coord;\n"
+		"flat in vec2 fragSize;\n"
+		"flat in vec3 fragArc;\n"
+		"flat in vec4 fragColor;\n"
 		"out vec4 finalColor;\n"
 		
 		"void main() {\n"
+		"  float radius = fragSize.x;\n"
+		"  float width = fragSize.y;\n"
+		"  float angle = fragArc.x;\n"
+		"  float startAngle = fragArc.y;\n"
+		"  float dash = fragArc.z;\n"
 		"  float arc = mod(atan(coord.x, coord.y) + pi + startAngle, 2 * pi);\n"
 		"  float arcFalloff = 1 - min(2 * pi - arc, arc - angle) * radius;\n"
 		"  if(dash != 0)\n"
@@ -78,40 +79,19 @@ void RingShader::Init()
 		"  float len = length(coord);\n"
 		"  float lenFalloff = width - abs(len - radius);\n"
 		"  float alpha = clamp(min(arcFalloff, lenFalloff), 0, 1);\n"
-		"  finalColor = color * alpha;\n"
+		"  finalColor = fragColor * alpha;\n"
 		"}\n";
 	
 	shader = Shader(vertexCode, fragmentCode);
-	scaleI = shader.Uniform("scale");
-	positionI = shader.Uniform("position");
-	radiusI = shader.Uniform("radius");
-	widthI = shader.Uniform("width");
-	angleI = shader.Uniform("angle");
-	startAngleI = shader.Uniform("startAngle");
-	dashI = shader.Uniform("dash");
-	colorI = shader.Uniform("color");
-	
-	// Generate the vertex data for drawing sprites.
-	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
-	
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
 	
-	GLfloat vertexData[] = {
+	// Generate the vertex data for drawing rings.
+	static const GLfloat vertexData[] = {
 		-1.f, -1.f,
 		-1.f,  1.f,
 		 1.f, -1.f,
 		 1.f,  1.f
 	};
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertexData), vertexData, GL_STATIC_DRAW);
-	
-	glEnableVertexAttribArray(shader.Attrib("vert"));
-	glVertexAttribPointer(shader.Attrib("vert"), 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
-	
-	// unbind the VBO and VAO
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	batch.Init(shader, vertexData, 4, GL_TRIANGLE_STRIP, {{"position", 2}, {"size", 2}, {"arc", 3}, {"color", 4}});
 }
 
 
@@ -140,11 +120,7 @@ void RingShader::Bind()
 	if(!shader.Object())
 		throw runtime_error("RingShader: Bind() called before Init().");
 	
-	glUseProgram(shader.Object());
-	glBindVertexArray(vao);
-	
-	GLfloat scale[2] = {2.f / Screen::Width(), -2.f / Screen::Height()};
-	glUniform2fv(scaleI, 1, scale);
+	PrimitiveBatch::Begin();
 }
 
 
@@ -159,24 +135,20 @@ void RingShader::Add(const Point &pos, float out, float in, const Color &color)
 
 void RingShader::Add(const Point &pos, float radius, float width, float fraction, const Color &color, float dash, float startAngle)
 {
-	GLfloat position[2] = {static_cast<float>(pos.X()), static_cast<float>(pos.Y())};
-	glUniform2fv(positionI, 1, position);
-	
-	glUniform1f(radiusI, radius);
-	glUniform1f(widthI, width);
-	glUniform1f(angleI, fraction * 2. * PI);
-	glUniform1f(startAngleI, startAngle * TO_RAD);
-	glUniform1f(dashI, dash ? 2. * PI / dash : 0.);
-	
-	glUniform4fv(colorI, 1, color.Get());
-	
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	const float *rgba = color.Get();
+	GLfloat values[11] = {
+		static_cast<float>(pos.X()), static_cast<float>(pos.Y()),
+		radius, width,
+		static_cast<float>(fraction * 2. * PI),
+		static_cast<float>(startAngle * TO_RAD),
+		static_cast<float>(dash ? 2. * PI / dash : 0.),
+		rgba[0], rgba[1], rgba[2], rgba[3]};
+	batch.Add(values);
 }
 
 
 
 void RingShader::Unbind()
 {
-	glBindVertexArray(0);
-	glUseProgram(0);
+	PrimitiveBatch::End();
 }
@@ -53,6 +53,59 @@ namespace {
 	
 	const double SCAN_TIME = 60.;
 	
+	// Attributes that are looked up every frame.
+	const Dictionary::Key ACTIVE_COOLING("active cooling");
+	const Dictionary::Key AFTERBURNER_ENERGY("afterburner energy");
+	const Dictionary::Key AFTERBURNER_FUEL("afterburner fuel");
+	const Dictionary::Key AFTERBURNER_HEAT("afterburner heat");
+	const Dictionary::Key AFTERBURNER_THRUST("afterburner thrust");
+	const Dictionary::Key CLOAK("cloak");
+	const Dictionary::Key CLOAKING_ENERGY("cloaking energy");
+	const Dictionary::Key CLOAKING_FUEL("cloaking fuel");
+	const Dictionary::Key CLOAKING_HEAT("cloaking heat");
+	const Dictionary::Key COOLING("cooling");
+	const Dictionary::Key COOLING_ENERGY("cooling energy");
+	const Dictionary::Key DISRUPTION_RESISTANCE("disruption resistance");
+	const Dictionary::Key DRAG("drag");
+	const Dictionary::Key ENERGY_CAPACITY("energy capacity");
+	const Dictionary::Key ENERGY_CONSUMPTION("energy consumption");
+	const Dictionary::Key ENERGY_GENERATION("energy generation");
+	const Dictionary::Key FUEL_CAPACITY("fuel capacity");
+	const Dictionary::Key FUEL_CONSUMPTION("fuel consumption");
+	const Dictionary::Key FUEL_ENERGY("fuel energy");
+	const Dictionary::Key FUEL_GENERATION("fuel generation");
+	const Dictionary::Key FUEL_HEAT("fuel heat");
+	const Dictionary::Key HEAT_DISSIPATION("heat dissipation");
+	const Dictionary::Key HEAT_GENERATION("heat generation");
+	const Dictionary::Key HULL("hull");
+	const Dictionary::Key HULL_ENERGY("hull energy");
+	const Dictionary::Key HULL_FUEL("hull fuel");
+	const Dictionary::Key HULL_HEAT("hull heat");
+	const Dictionary::Key HULL_REPAIR_RATE("hull repair rate");
+	const Dictionary::Key HYPERDRIVE("hyperdrive");
+	const Dictionary::Key ION_RESISTANCE("ion resistance");
+	const Dictionary::Key JUMP_DRIVE("jump drive");
+	const Dictionary::Key RAMSCOOP("ramscoop");
+	const Dictionary::Key REVERSE_THRUST("reverse thrust");
+	const Dictionary::Key REVERSE_THRUSTING_ENERGY("reverse thrusting energy");
+	const Dictionary::Key REVERSE_THRUSTING_HEAT("reverse thrusting heat");
+	const Dictionary::Key SHIELD_ENERGY("shield energy");
+	const Dictionary::Key SHIELD_FUEL("shield fuel");
+	const Dictionary::Key SHIELD_GENERATION("shield generation");
+	const Dictionary::Key SHIELD_HEAT("shield heat");
+	const Dictionary::Key SHIELDS("shields");
+	const Dictionary::Key SLOWING_RESISTANCE("slowing resistance");
+	const Dictionary::Key SOLAR_COLLECTION("solar collection");
+	const Dictionary::Key THRUST("thrust");
+	const Dictionary::Key THRUSTING_ENERGY("thrusting energy");
+	const Dictionary::Key THRUSTING_HEAT("thrusting heat");
+	const Dictionary::Key TURN("turn");
+	const Dictionary::Key TURNING_ENERGY("turning energy");
+	const Dictionary::Key TURNING_HEAT("turning heat");
+	const Dictionary::Key AUTOMATON("automaton");
+	const Dictionary::Key COOLING_INEFFICIENCY("cooling inefficiency");
+	const Dictionary::Key REQUIRED_CREW("required crew");
+	
 	// Helper function to transfer energy to a given stat if it is less than the
 	// given maximum value.
 	void DoRepair(double &stat, double &available, double maximum)
@@ -519,6 +572,7 @@ void Ship::FinishLoading(bool isNewInstance)
 	cargo.SetSize(attributes.Get("cargo space"));
 	equipped.clear();
 	armament.FinishLoading();
+	CacheAttributes();
 	
 	// Figure out how far from center the farthest hardpoint is.
 	weaponRadius = 0.;
@@ -1003,7 +1057,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 		return;
 	}
 	isInSystem = false;
-	if(!fuel || !(attributes.Get("hyperdrive") || attributes.Get("jump drive")))
+	if(!fuel || !(attributes.Get(HYPERDRIVE) || attributes.Get(JUMP_DRIVE)))
 		hyperspaceSystem = nullptr;
 	
 	// Adjust the error in the pilot's targeting.
@@ -1039,16 +1093,16 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 		if(!cloak)
 			cloakDisruption = max(0., cloakDisruption - 1.);
 		
-		double cloakingSpeed = attributes.Get("cloak");
+		double cloakingSpeed = attributes.Get(CLOAK);
 		bool canCloak = (!isDisabled && cloakingSpeed > 0. && !cloakDisruption
-			&& fuel >= attributes.Get("cloaking fuel")
-			&& energy >= attributes.Get("cloaking energy"));
+			&& fuel >= attributes.Get(CLOAKING_FUEL)
+			&& energy >= attributes.Get(CLOAKING_ENERGY));
 		if(commands.Has(Command::CLOAK) && canCloak)
 		{
 			cloak = min(1., cloak + cloakingSpeed);
-			fuel -= attributes.Get("cloaking fuel");
-			energy -= attributes.Get("cloaking energy");
-			heat += attributes.Get("cloaking heat");
+			fuel -= attributes.Get(CLOAKING_FUEL);
+			energy -= attributes.Get(CLOAKING_ENERGY);
+			heat += attributes.Get(CLOAKING_HEAT);
 		}
 		else if(cloakingSpeed)
 		{
@@ -1304,7 +1358,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 			}
 		}
 		// Only refuel if this planet has a spaceport.
-		else if(fuel >= attributes.Get("fuel capacity")
+		else if(fuel >= attributes.Get(FUEL_CAPACITY)
 				|| !landingPlanet || !landingPlanet->HasSpaceport())
 		{
 			zoom = min(1.f, zoom + .02f);
@@ -1312,7 +1366,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 			landingPlanet = nullptr;
 		}
 		else
-			fuel = min(fuel + 1., attributes.Get("fuel capacity"));
+			fuel = min(fuel + 1., attributes.Get(FUEL_CAPACITY));
 		
 		// Move the ship at the velocity it had when it began landing, but
 		// scaled based on how small it is now.
@@ -1330,7 +1384,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 	else if(commands.Has(Command::JUMP) && IsReadyToJump())
 	{
 		hyperspaceSystem = GetTargetSystem();
-		isUsingJumpDrive = !attributes.Get("hyperdrive") || !currentSystem->Links().count(hyperspaceSystem);
+		isUsingJumpDrive = !attributes.Get(HYPERDRIVE) || !currentSystem->Links().count(hyperspaceSystem);
 		hyperspaceFuelCost = JumpFuel(hyperspaceSystem);
 	}
 	
@@ -1357,13 +1411,13 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 	// disabled, all it can do is slow down to a stop.
 	double mass = Mass();
 	if(isDisabled)
-		velocity *= 1. - attributes.Get("drag") / mass;
+		velocity *= 1. - attributes.Get(DRAG) / mass;
 	else if(!pilotError)
 	{
 		if(commands.Turn())
 		{
 			// Check if we are able to turn.
-			double cost = attributes.Get("turning energy");
+			double cost = attributes.Get(TURNING_ENERGY);
 			if(energy < cost * fabs(commands.Turn()))
 				commands.SetTurn(commands.Turn() * energy / (cost * fabs(commands.Turn())));
 			
@@ -1374,7 +1428,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 				// of the turning energy and produce a fraction of the heat.
 				double scale = fabs(commands.Turn());
 				energy -= scale * cost;
-				heat += scale * attributes.Get("turning heat");
+				heat += scale * attributes.Get(TURNING_HEAT);
 				angle += commands.Turn() * TurnRate() * slowMultiplier;
 			}
 		}
@@ -1384,7 +1438,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 		{
 			// Check if we are able to apply this thrust.
 			double cost = attributes.Get((thrustCommand > 0.) ?
-				"thrusting energy" : "reverse thrusting energy");
+				THRUSTING_ENERGY : REVERSE_THRUSTING_ENERGY);
 			if(energy < cost)
 				thrustCommand *= energy / cost;
 			
@@ -1393,12 +1447,12 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 				// If a reverse thrust is commanded and the capability does not
 				// exist, ignore it (do not even slow under drag).
 				isThrusting = (thrustCommand > 0.);
-				thrust = attributes.Get(isThrusting ? "thrust" : "reverse thrust");
+				thrust = attributes.Get(isThrusting ? THRUST : REVERSE_THRUST);
 				if(thrust)
 				{
 					double scale = fabs(thrustCommand);
 					energy -= scale * cost;
-					heat += scale * attributes.Get(isThrusting ? "thrusting heat" : "reverse thrusting heat");
+					heat += scale * attributes.Get(isThrusting ? THRUSTING_HEAT : REVERSE_THRUSTING_HEAT);
 					acceleration += angle.Unit() * (thrustCommand * thrust / mass);
 				}
 			}
@@ -1407,12 +1461,12 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 				&& !CannotAct();
 		if(applyAfterburner)
 		{
-			thrust = attributes.Get("afterburner thrust");
-			double fuelCost = attributes.Get("afterburner fuel");
-			double energyCost = attributes.Get("afterburner energy");
+			thrust = attributes.Get(AFTERBURNER_THRUST);
+			double fuelCost = attributes.Get(AFTERBURNER_FUEL);
+			double energyCost = attributes.Get(AFTERBURNER_ENERGY);
 			if(thrust && fuel >= fuelCost && energy >= energyCost)
 			{
-				heat += attributes.Get("afterburner heat");
+				heat += attributes.Get(AFTERBURNER_HEAT);
 				fuel -= fuelCost;
 				energy -= energyCost;
 				acceleration += angle.Unit() * thrust / mass;
@@ -1432,7 +1486,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 	if(acceleration)
 	{
 		acceleration *= slowMultiplier;
-		Point dragAcceleration = acceleration - velocity * (attributes.Get("drag") / mass);
+		Point dragAcceleration = acceleration - velocity * (attributes.Get(DRAG) / mass);
 		// Make sure dragAcceleration has nonzero length, to avoid divide by zero.
 		if(dragAcceleration)
 		{
@@ -1559,19 +1613,19 @@ void Ship::DoGeneration()
 		// 4. Shields of carried fighters
 		// 5. Transfer of excess energy and fuel to carried fighters.
 		
-		const double hullAvailable = attributes.Get("hull repair rate");
-		const double hullEnergy = attributes.Get("hull energy") / hullAvailable;
-		const double hullFuel = attributes.Get("hull fuel") / hullAvailable;
-		const double hullHeat = attributes.Get("hull heat") / hullAvailable;
+		const double hullAvailable = attributes.Get(HULL_REPAIR_RATE);
+		const double hullEnergy = attributes.Get(HULL_ENERGY) / hullAvailable;
+		const double hullFuel = attributes.Get(HULL_FUEL) / hullAvailable;
+		const double hullHeat = attributes.Get(HULL_HEAT) / hullAvailable;
 		double hullRemaining = hullAvailable;
-		DoRepair(hull, hullRemaining, attributes.Get("hull"), energy, hullEnergy, fuel, hullFuel);
+		DoRepair(hull, hullRemaining, attributes.Get(HULL), energy, hullEnergy, fuel, hullFuel);
 		
-		const double shieldsAvailable = attributes.Get("shield generation");
-		const double shieldsEnergy = attributes.Get("shield energy") / shieldsAvailable;
-		const double shieldsFuel = attributes.Get("shield fuel") / shieldsAvailable;
-		const double shieldsHeat = attributes.Get("shield heat") / shieldsAvailable;
+		const double shieldsAvailable = attributes.Get(SHIELD_GENERATION);
+		const double shieldsEnergy = attributes.Get(SHIELD_ENERGY) / shieldsAvailable;
+		const double shieldsFuel = attributes.Get(SHIELD_FUEL) / shieldsAvailable;
+		const double shieldsHeat = attributes.Get(SHIELD_HEAT) / shieldsAvailable;
 		double shieldsRemaining = shieldsAvailable;
-		DoRepair(shields, shieldsRemaining, attributes.Get("shields"), energy, shieldsEnergy, fuel, shieldsFuel);
+		DoRepair(shields, shieldsRemaining, attributes.Get(SHIELDS), energy, shieldsEnergy, fuel, shieldsFuel);
 		
 		if(!bays.empty())
 		{
@@ -1598,19 +1652,19 @@ void Ship::DoGeneration()
 			for(const pair<double, Ship *> &it : carried)
 			{
 				Ship &ship = *it.second;
-				DoRepair(ship.hull, hullRemaining, ship.attributes.Get("hull"), energy, hullEnergy, fuel, hullFuel);
-				DoRepair(ship.shields, shieldsRemaining, ship.attributes.Get("shields"), energy, shieldsEnergy, fuel, shieldsFuel);
+				DoRepair(ship.hull, hullRemaining, ship.attributes.Get(HULL), energy, hullEnergy, fuel, hullFuel);
+				DoRepair(ship.shields, shieldsRemaining, ship.attributes.Get(SHIELDS), energy, shieldsEnergy, fuel, shieldsFuel);
 			}
 			
 			// Now that there is no more need to use energy for hull and shield
 			// repair, if there is still excess energy, transfer it.
-			double energyRemaining = min(0., energy - attributes.Get("energy capacity"));
-			double fuelRemaining = min(0., fuel - attributes.Get("fuel capacity"));
+			double energyRemaining = min(0., energy - attributes.Get(ENERGY_CAPACITY));
+			double fuelRemaining = min(0., fuel - attributes.Get(FUEL_CAPACITY));
 			for(const pair<double, Ship *> &it : carried)
 			{
 				Ship &ship = *it.second;
-				DoRepair(ship.energy, energyRemaining, ship.attributes.Get("energy capacity"));
-				DoRepair(ship.fuel, fuelRemaining, ship.attributes.Get("fuel capacity"));
+				DoRepair(ship.energy, energyRemaining, ship.attributes.Get(ENERGY_CAPACITY));
+				DoRepair(ship.fuel, fuelRemaining, ship.attributes.Get(FUEL_CAPACITY));
 			}
 		}
 		
@@ -1624,18 +1678,18 @@ void Ship::DoGeneration()
 	}
 	// Handle ionization effects, etc.
 	if(ionization)
-		ionization = max(0., .99 * ionization - attributes.Get("ion resistance"));
+		ionization = max(0., .99 * ionization - attributes.Get(ION_RESISTANCE));
 	if(disruption)
-		disruption = max(0., .99 * disruption - attributes.Get("disruption resistance"));
+		disruption = max(0., .99 * disruption - attributes.Get(DISRUPTION_RESISTANCE));
 	if(slowness)
-		slowness = max(0., .99 * slowness - attributes.Get("slowing resistance"));
+		slowness = max(0., .99 * slowness - attributes.Get(SLOWING_RESISTANCE));
 	
 	// When ships recharge, what actually happens is that they can exceed their
 	// maximum capacity for the rest of the turn, but must be clamped to the
 	// maximum here before they gain more. This is so that, for example, a ship
 	// with no batteries but a good generator can still move.
-	energy = min(energy, attributes.Get("energy capacity"));
-	fuel = min(fuel, attributes.Get("fuel capacity"));
+	energy = min(energy, attributes.Get(ENERGY_CAPACITY));
+	fuel = min(fuel, attributes.Get(FUEL_CAPACITY));
 	
 	heat -= heat * HeatDissipation();
 	if(heat > MaximumHeat())
@@ -1643,9 +1697,9 @@ void Ship::DoGeneration()
 	else if(heat < .9 * MaximumHeat())
 		isOverheated = false;
 	
-	double maxShields = attributes.Get("shields");
+	double maxShields = attributes.Get(SHIELDS);
 	shields = min(shields, maxShields);
-	double maxHull = attributes.Get("hull");
+	double maxHull = attributes.Get(HULL);
 	hull = min(hull, maxHull);
 	
 	isDisabled = isOverheated || hull < MinimumHull() || (!crew && RequiredCrew());
@@ -1670,34 +1724,34 @@ void Ship::DoGeneration()
 		if(currentSystem)
 		{
 			double scale = .2 + 1.8 / (.001 * position.Length() + 1);
-			fuel += currentSystem->SolarWind() * .03 * scale * (sqrt(attributes.Get("ramscoop")) + .05 * scale);
+			fuel += currentSystem->SolarWind() * .03 * scale * (sqrt(attributes.Get(RAMSCOOP)) + .05 * scale);
 		
-			energy += currentSystem->SolarPower() * scale * attributes.Get("solar collection");
+			energy += currentSystem->SolarPower() * scale * attributes.Get(SOLAR_COLLECTION);
 		}
 		
 		double coolingEfficiency = CoolingEfficiency();
-		energy += attributes.Get("energy generation") - attributes.Get("energy consumption");
+		energy += attributes.Get(ENERGY_GENERATION) - attributes.Get(ENERGY_CONSUMPTION);
 		energy -= ionization;
-		fuel += attributes.Get("fuel generation");
-		heat += attributes.Get("heat generation");
-		heat -= coolingEfficiency * attributes.Get("cooling");
+		fuel += attributes.Get(FUEL_GENERATION);
+		heat += attributes.Get(HEAT_GENERATION);
+		heat -= coolingEfficiency * attributes.Get(COOLING);
 		
 		// Convert fuel into energy and heat only when the required amount of fuel is available.
-		if(attributes.Get("fuel consumption") <= fuel)
+		if(attributes.Get(FUEL_CONSUMPTION) <= fuel)
 		{	
-			fuel -= attributes.Get("fuel consumption");
-			energy += attributes.Get("fuel energy");
-			heat += attributes.Get("fuel heat");
+			fuel -= attributes.Get(FUEL_CONSUMPTION);
+			energy += attributes.Get(FUEL_ENERGY);
+			heat += attributes.Get(FUEL_HEAT);
 		}
 		
 		// Apply active cooling. The fraction of full cooling to apply equals
 		// your ship's current fraction of its maximum temperature.
-		double activeCooling = coolingEfficiency * attributes.Get("active cooling");
+		double activeCooling = coolingEfficiency * attributes.Get(ACTIVE_COOLING);
 		if(activeCooling > 0. && heat > 0.)
 		{
 			// Although it's a misuse of this feature, handle the case where
 			// "active cooling" does not require any energy.
-			double coolingEnergy = attributes.Get("cooling energy");
+			double coolingEnergy = attributes.Get(COOLING_ENERGY);
 			if(coolingEnergy)
 			{
 				double spentEnergy = min(energy, coolingEnergy * min(1., Heat()));
@@ -2339,7 +2393,7 @@ void Ship::WasCaptured(const shared_ptr<Ship> &capturer)
 // Get characteristics of this ship, as a fraction between 0 and 1.
 double Ship::Shields() const
 {
-	double maximum = attributes.Get("shields");
+	double maximum = attributes.Get(SHIELDS);
 	return maximum ? min(1., shields / maximum) : 0.;
 }
 
@@ -2347,7 +2401,7 @@ double Ship::Shields() const
 
 double Ship::Hull() const
 {
-	double maximum = attributes.Get("hull");
+	double maximum = attributes.Get(HULL);
 	return maximum ? min(1., hull / maximum) : 1.;
 }
 
@@ -2355,7 +2409,7 @@ double Ship::Hull() const
 
 double Ship::Fuel() const
 {
-	double maximum = attributes.Get("fuel capacity");
+	double maximum = attributes.Get(FUEL_CAPACITY);
 	return maximum ? min(1., fuel / maximum) : 0.;
 }
 
@@ -2363,7 +2417,7 @@ double Ship::Fuel() const
 
 double Ship::Energy() const
 {
-	double maximum = attributes.Get("energy capacity");
+	double maximum = attributes.Get(ENERGY_CAPACITY);
 	return maximum ? min(1., energy / maximum) : (hull > 0.) ? 1. : 0.;
 }
 
@@ -2383,8 +2437,8 @@ double Ship::Heat() const
 double Ship::Health() const
 {
 	double minimumHull = MinimumHull();
-	double hullDivisor = attributes.Get("hull") - minimumHull;
-	double divisor = attributes.Get("shields") + hullDivisor;
+	double hullDivisor = attributes.Get(HULL) - minimumHull;
+	double divisor = attributes.Get(SHIELDS) + hullDivisor;
 	// This should not happen, but just in case.
 	if(divisor <= 0. || hullDivisor <= 0.)
 		return 0.;
@@ -2399,7 +2453,7 @@ double Ship::Health() const
 // Get the hull fraction at which this ship is disabled.
 double Ship::DisabledHull() const
 {
-	double hull = attributes.Get("hull");
+	double hull = attributes.Get(HULL);
 	double minimumHull = MinimumHull();
 	
 	return (hull > 0. ? minimumHull / hull : 0.);
@@ -2484,14 +2538,14 @@ double Ship::IdleHeat() const
 {
 	// This ship's cooling ability:
 	double coolingEfficiency = CoolingEfficiency();
-	double cooling = coolingEfficiency * attributes.Get("cooling");
-	double activeCooling = coolingEfficiency * attributes.Get("active cooling");
+	double cooling = coolingEfficiency * attributes.Get(COOLING);
+	double activeCooling = coolingEfficiency * attributes.Get(ACTIVE_COOLING);
 	
 	// Idle heat is the heat level where:
 	// heat = heat * diss + heatGen - cool - activeCool * heat / (100 * mass)
 	// heat = heat * (diss - activeCool / (100 * mass)) + (heatGen - cool)
 	// heat * (1 - diss + activeCool / (100 * mass)) = (heatGen - cool)
-	double production = max(0., attributes.Get("heat generation") - cooling);
+	double production = max(0., attributes.Get(HEAT_GENERATION) - cooling);
 	double dissipation = HeatDissipation() + activeCooling / MaximumHeat();
 	return production / dissipation;
 }
@@ -2501,7 +2555,7 @@ double Ship::IdleHeat() const
 // Get the heat dissipation, in heat units per heat unit per frame.
 double Ship::HeatDissipation() const
 {
-	return .001 * attributes.Get("heat dissipation");
+	return .001 * attributes.Get(HEAT_DISSIPATION);
 }
 
 
@@ -2517,11 +2571,7 @@ double Ship::MaximumHeat() const
 // Calculate the multiplier for cooling efficiency.
 double Ship::CoolingEfficiency() const
 {
-	// This is an S-curve where the efficiency is 100% if you have no outfits
-	// that create "cooling inefficiency", and as that value increases the
-	// efficiency stays high for a while, then drops off, then approaches 0.
-	double x = attributes.Get("cooling inefficiency");
-	return 2. + 2. / (1. + exp(x / -2.)) - 4. / (1. + exp(x / -4.));
+	return coolingEfficiency;
 }
 
 
@@ -2535,11 +2585,7 @@ int Ship::Crew() const
 
 int Ship::RequiredCrew() const
 {
-	if(attributes.Get("automaton"))
-		return 0;
-	
-	// Drones do not need crew, but all other ships need at least one.
-	return max<int>(1, attributes.Get("required crew"));
+	return requiredCrew;
 }
 
 
@@ -2568,15 +2614,15 @@ double Ship::Mass() const
 
 double Ship::TurnRate() const
 {
-	return attributes.Get("turn") / Mass();
+	return attributes.Get(TURN) / Mass();
 }
 
 
 
 double Ship::Acceleration() const
 {
-	double thrust = attributes.Get("thrust");
-	return (thrust ? thrust : attributes.Get("afterburner thrust")) / Mass();
+	double thrust = attributes.Get(THRUST);
+	return (thrust ? thrust : attributes.Get(AFTERBURNER_THRUST)) / Mass();
 }
 
 
@@ -2586,15 +2632,15 @@ double Ship::MaxVelocity() const
 	// v * drag / mass == thrust / mass
 	// v * drag == thrust
 	// v = thrust / drag
-	double thrust = attributes.Get("thrust");
-	return (thrust ? thrust : attributes.Get("afterburner thrust")) / attributes.Get("drag");
+	double thrust = attributes.Get(THRUST);
+	return (thrust ? thrust : attributes.Get(AFTERBURNER_THRUST)) / attributes.Get(DRAG);
 }
 
 
 
 double Ship::MaxReverseVelocity() const
 {
-	return attributes.Get("reverse thrust") / attributes.Get("drag");
+	return attributes.Get(REVERSE_THRUST) / attributes.Get(DRAG);
 }
 
 
@@ -2914,6 +2960,7 @@ void Ship::AddOutfit(const Outfit *outfit, int count)
 				outfits.erase(it);
 		}
 		attributes.Add(*outfit, count);
+		CacheAttributes();
 		if(outfit->IsWeapon())
 			armament.Add(outfit, count);
 		
@@ -3131,11 +3178,25 @@ void Ship::RemoveEscort(const Ship &ship)
 
 double Ship::MinimumHull() const
 {
-	if(neverDisabled)
-		return 0.;
+	return neverDisabled ? 0. : minimumHull;
+}
+
+
+
+// Update the values that are derived from this ship's attributes.
+void Ship::CacheAttributes()
+{
+	double maximumHull = attributes.Get(HULL);
+	minimumHull = floor(maximumHull * max(.15, min(.45, 10. / sqrt(maximumHull))));
 	
-	double maximumHull = attributes.Get("hull");
-	return floor(maximumHull * max(.15, min(.45, 10. / sqrt(maximumHull))));
+	// This is an S-curve where the efficiency is 100% if you have no outfits
+	// that create "cooling inefficiency", and as that value increases the
+	// efficiency stays high for a while, then drops off, then approaches 0.
+	double x = attributes.Get(COOLING_INEFFICIENCY);
+	coolingEfficiency = 2. + 2. / (1. + exp(x / -2.)) - 4. / (1. + exp(x / -4.));
+	
+	// Drones do not need crew, but all other ships need at least one.
+	requiredCrew = attributes.Get(AUTOMATON) ? 0 : max<int>(1, attributes.Get(REQUIRED_CREW));
 }
 
 
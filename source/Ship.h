@@ -383,6 +383,8 @@ private:
 	void RemoveEscort(const Ship &ship);
 	// Get the hull amount at which this ship is disabled.
 	double MinimumHull() const;
+	// Update the values that are derived from this ship's attributes.
+	void CacheAttributes();
 	// Find out how much fuel is consumed by the hyperdrive of the given type.
 	double BestFuel(const std::string &type, const std::string &subtype, double defaultFuel) const;
 	// Create one of this ship's explosions, within its mask. The explosions can
@@ -434,6 +436,11 @@ private:
 	// Cached values for figuring out when anti-missile is in range.
 	double antiMissileRange = 0.;
 	double weaponRadius = 0.;
+	// Cached values derived from the attributes, which are updated whenever
+	// the outfits change so that they are not recomputed every frame.
+	double minimumHull = 0.;
+	double coolingEfficiency = 1.;
+	int requiredCrew = 1;
 	// Cargo and outfit scanning takes time.
 	double cargoScan = 0.;
 	double outfitScan = 0.;
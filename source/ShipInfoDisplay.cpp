@@ -15,6 +15,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Color.h"
 #include "Depreciation.h"
 #include "FillShader.h"
+#include "Font.h"
 #include "Format.h"
 #include "GameData.h"
 #include "Outfit.h"
@@ -79,6 +80,7 @@ void ShipInfoDisplay::DrawAttributes(const Point &topLeft) const
 	table.DrawAt(point);
 	table.DrawGap(10.);
 	
+	Font::BeginBatch();
 	table.Advance();
 	table.Draw("energy", labelColor);
 	table.Draw("heat", labelColor);
@@ -90,6 +92,7 @@ void ShipInfoDisplay::DrawAttributes(const Point &topLeft) const
 		table.Draw(energyTable[i], valueColor);
 		table.Draw(heatTable[i], valueColor);
 	}
+	Font::EndBatch();
 }
 
 
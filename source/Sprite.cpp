@@ -15,6 +15,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "ImageBuffer.h"
 #include "Preferences.h"
 #include "Screen.h"
+#include "SpriteAtlas.h"
 
 #include "gl_header.h"
 #include <SDL2/SDL.h>
@@ -23,6 +24,72 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 using namespace std;
 
+namespace {
+	// This texture is drawn in place of any sprite that is not loaded.
+	uint32_t placeholder = 0;
+	
+	// Check whether the S3TC texture compression formats are available.
+	bool CanCompress()
+	{
+#ifdef __APPLE__
+		return true;
+#else
+		return GLEW_EXT_texture_compression_s3tc;
+#endif
+	}
+	
+	// Get the number of bytes of texture memory the given image will take up.
+	size_t TextureSize(const ImageBuffer &buffer, bool compress)
+	{
+		size_t width = buffer.Width();
+		size_t height = buffer.Height();
+		// The compressed format stores each 4x4 block in 16 bytes.
+		if(compress)
+			return 16 * ((width + 3) / 4) * ((height + 3) / 4) * buffer.Frames();
+		return 4 * width * height * buffer.Frames();
+	}
+}
+
+
+
+// Get the texture coordinates of the given frame's top left corner, and the
+// index of the layer that it is in.
+void Sprite::Layout::Corner(int frame, float *corner) const
+{
+	if(!grid[0])
+	{
+		corner[0] = rect[0];
+		corner[1] = rect[1];
+		corner[2] = frame;
+		return;
+	}
+	
+	int columns = grid[0];
+	corner[0] = rect[0] + (frame % columns) * grid[1];
+	corner[1] = rect[1] + (frame / columns) * grid[2];
+	corner[2] = 0.f;
+}
+
+
+
+// Create the placeholder texture. This must be done in the thread that owns
+// the OpenGL context, before any sprites are drawn.
+void Sprite::InitPlaceholder()
+{
+	if(placeholder)
+		return;
+	
+	// The placeholder is a single transparent pixel, so a sprite that is still
+	// being loaded is invisible rather than being drawn as a black rectangle.
+	const uint32_t pixel = 0;
+	glGenTextures(1, &placeholder);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, placeholder);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, 1, 1, 1, 0, GL_BGRA, GL_UNSIGNED_BYTE, &pixel);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
 
 
 Sprite::Sprite(const string &name)
@@ -39,42 +106,86 @@ const string &Sprite::Name() const
 
 
 
-// Upload the given frames. The given buffer will be cleared afterwards.
-void Sprite::AddFrames(ImageBuffer &buffer, bool is2x)
+// Upload the given frames. The given buffer will be cleared afterwards. If
+// upload is false, only the sprite's dimensions are taken from the buffer.
+void Sprite::AddFrames(ImageBuffer &buffer, bool is2x, bool upload)
 {
 	// Do nothing if the buffer is empty.
 	if(!buffer.Pixels())
 		return;
 	
-	// If this is the 1x image, its dimensions determine the sprite's size.
-	if(!is2x)
+	// If this is the 1x image, its dimensions determine the sprite's size. If
+	// the textures are being reloaded, the size is already known (and other
+	// threads may be reading it).
+	if(!is2x && !frames)
 	{
 		width = buffer.Width();
 		height = buffer.Height();
 		frames = buffer.Frames();
 	}
 	
+	// Sprites in an atlas are never unloaded, so there is no need to upload
+	// them again.
+	if(!upload || inAtlas[is2x])
+	{
+		buffer.Clear();
+		return;
+	}
+	
+	// Small sprites are packed into a shared texture instead of having their
+	// own. Their textures are not counted in this sprite's memory use.
+	Layout atlasLayout;
+	uint32_t id = SpriteAtlas::Add(buffer, is2x, atlasLayout);
+	if(id)
+	{
+		layout[is2x] = atlasLayout;
+		inAtlas[is2x] = true;
+		texture[is2x].store(id, memory_order_release);
+		buffer.Clear();
+		return;
+	}
+	
 	// Check whether this sprite is large enough to require size reduction.
 	if(Preferences::Has("Reduce large graphics") && buffer.Width() * buffer.Height() >= 1000000)
 		buffer.ShrinkToHalfSize();
 	
+	// With the "Compress graphics" preference, the texture is stored in a block
+	// compressed format, which is a quarter of the size, and it has mipmaps so
+	// that it looks smoother when zoomed out.
+	bool compress = Preferences::Has("Compress graphics") && CanCompress();
+	GLenum format = compress ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_RGBA8;
+	
 	// Upload the images as a single array texture.
-	glGenTextures(1, &texture[is2x]);
-	glBindTexture(GL_TEXTURE_2D_ARRAY, texture[is2x]);
+	glGenTextures(1, &id);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, id);
 	
 	// Use linear interpolation and no wrapping.
-	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, compress ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 	
-	// Upload the image data.
-	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, // target, mipmap level, internal format,
-		buffer.Width(), buffer.Height(), buffer.Frames(), // width, height, depth,
-		0, GL_BGRA, GL_UNSIGNED_BYTE, buffer.Pixels()); // border, input format, data type, data.
+	// Upload the image data. The mipmaps are made by shrinking the image by
+	// half until it is too small to shrink any more. (glGenerateMipmap() does
+	// not work with compressed textures.)
+	int level = 0;
+	while(true)
+	{
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, level, format, // target, mipmap level, internal format,
+			buffer.Width(), buffer.Height(), buffer.Frames(), // width, height, depth,
+			0, GL_BGRA, GL_UNSIGNED_BYTE, buffer.Pixels()); // border, input format, data type, data.
+		textureBytes += TextureSize(buffer, compress);
+		
+		if(!compress || buffer.Width() < 2 || buffer.Height() < 2)
+			break;
+		buffer.ShrinkToHalfSize();
+		++level;
+	}
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, level);
 	
 	// Unbind the texture.
 	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	texture[is2x].store(id, memory_order_release);
 	
 	// Free the ImageBuffer memory.
 	buffer.Clear();
@@ -92,16 +203,37 @@ void Sprite::AddMasks(vector<Mask> &masks)
 
 
 
-// Free up all textures loaded for this sprite.
-void Sprite::Unload()
+// Free up the textures loaded for this sprite, but not its dimensions or
+// masks. Rather than being deleted right away, the texture names are added to
+// the given list, because another thread may be about to draw them. Textures
+// in an atlas are shared with other sprites, so they are kept.
+void Sprite::UnloadTextures(vector<uint32_t> &names)
 {
-	glDeleteTextures(2, texture);
-	texture[0] = texture[1] = 0;
-	
-	masks.clear();
-	width = 0.f;
-	height = 0.f;
-	frames = 0;
+	for(int i = 0; i < 2; ++i)
+		if(!inAtlas[i])
+		{
+			uint32_t id = texture[i].exchange(0, memory_order_relaxed);
+			if(id)
+				names.push_back(id);
+		}
+	textureBytes = 0;
+}
+
+
+
+// Get the number of bytes of texture memory this sprite is using.
+size_t Sprite::TextureBytes() const
+{
+	return textureBytes;
+}
+
+
+
+// Check whether this sprite has been drawn since the last time this was
+// called, and clear that flag.
+bool Sprite::CheckUsed()
+{
+	return used.load(memory_order_relaxed) && used.exchange(false, memory_order_relaxed);
 }
 
 
@@ -150,7 +282,34 @@ uint32_t Sprite::Texture() const
 // Get the index of the texture for the given high DPI mode.
 uint32_t Sprite::Texture(bool isHighDPI) const
 {
-	return (isHighDPI && texture[1]) ? texture[1] : texture[0];
+	const Layout *unused;
+	return Texture(isHighDPI, unused);
+}
+
+
+
+// Get the texture index along with where the frames are in that texture.
+uint32_t Sprite::Texture(bool isHighDPI, const Layout *&layout) const
+{
+	// Avoid writing to the flag if it is already set, because many threads may
+	// be drawing this sprite.
+	if(!used.load(memory_order_relaxed))
+		used.store(true, memory_order_relaxed);
+	
+	// Each texture is only read once, so the texture and the layout always
+	// come from the same resolution.
+	int index = 1;
+	uint32_t id = isHighDPI ? texture[1].load(memory_order_acquire) : 0;
+	if(!id)
+	{
+		index = 0;
+		id = texture[0].load(memory_order_acquire);
+	}
+	
+	// The placeholder is a single pixel, so it uses the default layout.
+	static const Layout PLACEHOLDER;
+	layout = id ? &this->layout[index] : &PLACEHOLDER;
+	return id ? id : placeholder;
 }
 
 
@@ -16,6 +16,8 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Mask.h"
 #include "Point.h"
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -29,20 +31,56 @@ class ImageBuffer;
 // check whether something has collided with them. Each frame is stored in a
 // separate OpenGL texture object. This may not be as efficient as sprite
 // sheets, but with modern graphics cards it will not matter much and it makes
-// working with the graphics a lot simpler.
+// working with the graphics a lot simpler. A sprite's textures may be unloaded
+// to save memory when it has not been drawn for a while; its dimensions and
+// masks are kept, and until the textures are loaded again, a transparent
+// placeholder is drawn in their place.
 class Sprite {
+public:
+	// Where a sprite's frames are in its texture. Usually each frame is a whole
+	// layer of the texture, but small sprites share an atlas texture with other
+	// sprites, and their frames are laid out in a grid.
+	class Layout {
+	public:
+		// Get the texture coordinates of the given frame's top left corner, and
+		// the index of the layer that it is in.
+		void Corner(int frame, float *corner) const;
+		
+		// Position and size of the first frame, in texture coordinates.
+		float rect[4] = {0.f, 0.f, 1.f, 1.f};
+		// The number of columns in the grid (or zero if this is not in an atlas)
+		// and the distance from one frame to the next in each direction.
+		float grid[3] = {0.f, 0.f, 0.f};
+	};
+	
+	
+public:
+	// Create the placeholder texture. This must be done in the thread that
+	// owns the OpenGL context, before any sprites are drawn.
+	static void InitPlaceholder();
+	
+	
 public:
 	explicit Sprite(const std::string &name = "");
 	
 	const std::string &Name() const;
 	
-	// Upload the given frames. The given buffer will be cleared afterwards.
-	void AddFrames(ImageBuffer &buffer, bool is2x);
+	// Upload the given frames. The given buffer will be cleared afterwards. If
+	// upload is false, only the sprite's dimensions are taken from the buffer.
+	void AddFrames(ImageBuffer &buffer, bool is2x, bool upload = true);
 	// Move the given masks into this sprite's internal storage. The given
 	// vector will be cleared.
 	void AddMasks(std::vector<Mask> &masks);
-	// Free up all textures loaded for this sprite.
-	void Unload();
+	// Free up the textures loaded for this sprite, but not its dimensions or
+	// masks. Rather than being deleted right away, the texture names are added
+	// to the given list, because another thread may be about to draw them.
+	// Textures in an atlas are shared with other sprites, so they are kept.
+	void UnloadTextures(std::vector<uint32_t> &names);
+	// Get the number of bytes of texture memory this sprite is using.
+	size_t TextureBytes() const;
+	// Check whether this sprite has been drawn since the last time this was
+	// called, and clear that flag.
+	bool CheckUsed();
 	
 	// Image dimensions, in pixels.
 	float Width() const;
@@ -56,9 +94,13 @@ public:
 	Point Center() const;
 	
 	// Get the texture index, either looking it up based on the Screen's HighDPI
-	// setting or specifying it manually.
+	// setting or specifying it manually. This also marks the sprite as used.
 	uint32_t Texture() const;
 	uint32_t Texture(bool isHighDPI) const;
+	// Get the texture index along with where the frames are in that texture.
+	// Sprites may be drawn from another thread while their textures are being
+	// loaded, so the two must be read together to be sure that they match.
+	uint32_t Texture(bool isHighDPI, const Layout *&layout) const;
 	// Get the collision mask for the given frame of the animation.
 	const Mask &GetMask(int frame = 0) const;
 	
@@ -66,9 +108,21 @@ public:
 private:
 	std::string name;
 	
-	uint32_t texture[2] = {0, 0};
+	// The textures are read by the threads that draw this sprite, while they
+	// are loaded and unloaded by the main thread. Each texture's layout is set
+	// before the texture is stored, so anyone who sees the texture sees the
+	// layout that goes with it.
+	std::atomic<uint32_t> texture[2] = {{0}, {0}};
+	Layout layout[2];
+	// This is only used by the main thread.
+	bool inAtlas[2] = {false, false};
+	size_t textureBytes = 0;
 	std::vector<Mask> masks;
 	
+	// This is set whenever the texture is asked for, possibly from several
+	// threads at once.
+	mutable std::atomic<bool> used{false};
+	
 	float width = 0.f;
 	float height = 0.f;
 	int frames = 0;
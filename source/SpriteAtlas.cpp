@@ -0,0 +1,158 @@
+/* SpriteAtlas.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "SpriteAtlas.h"
+
+#include "ImageBuffer.h"
+
+#include "gl_header.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	// Width and height of each atlas texture.
+	const int SIZE = 1024;
+	// Only images this size or smaller (or twice this, for @2x images) are put
+	// in an atlas.
+	const int MAX_SPRITE = 64;
+	
+	// Each atlas is filled with rows ("shelves") of sprites. A sprite goes on
+	// the first shelf that it fits on, unless that would waste too much space.
+	class Shelf {
+	public:
+		Shelf(int y, int height) : y(y), height(height) {}
+		
+		int y;
+		int height;
+		int x = 0;
+	};
+	
+	class Atlas {
+	public:
+		GLuint texture = 0;
+		vector<Shelf> shelves;
+		int bottom = 0;
+	};
+	vector<Atlas> atlases;
+	
+	
+	// Find room in the given atlas for a block of the given size.
+	bool Place(Atlas &atlas, int width, int height, int &x, int &y)
+	{
+		Shelf *shelf = nullptr;
+		for(Shelf &it : atlas.shelves)
+			if(it.height >= height && it.height <= height + height / 2 && it.x + width <= SIZE)
+			{
+				shelf = &it;
+				break;
+			}
+		if(!shelf)
+		{
+			if(atlas.bottom + height > SIZE)
+				return false;
+			
+			atlas.shelves.emplace_back(atlas.bottom, height);
+			atlas.bottom += height;
+			shelf = &atlas.shelves.back();
+		}
+		x = shelf->x;
+		y = shelf->y;
+		shelf->x += width;
+		return true;
+	}
+	
+	
+	// Find room for a block of the given size, returning the atlas it is in.
+	Atlas &Allocate(int width, int height, int &x, int &y)
+	{
+		for(Atlas &atlas : atlases)
+			if(Place(atlas, width, height, x, y))
+				return atlas;
+		
+		// None of the atlases have room, so create a new one. Its contents are
+		// left uninitialized, because only the parts that are filled in with
+		// sprites will ever be drawn.
+		atlases.emplace_back();
+		Atlas &atlas = atlases.back();
+		glGenTextures(1, &atlas.texture);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, atlas.texture);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, SIZE, SIZE, 1, 0, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+		
+		Place(atlas, width, height, x, y);
+		return atlas;
+	}
+}
+
+
+
+// If the given image is small enough, copy all its frames into an atlas, fill
+// in the given layout, and return the atlas texture. Otherwise, return zero.
+// This must be called from the thread that owns the OpenGL context.
+uint32_t SpriteAtlas::Add(const ImageBuffer &buffer, bool is2x, Sprite::Layout &layout)
+{
+	int width = buffer.Width();
+	int height = buffer.Height();
+	int frames = buffer.Frames();
+	int limit = MAX_SPRITE << is2x;
+	if(width > limit || height > limit || !frames)
+		return 0;
+	
+	// Lay out the frames in a grid that is as wide as possible, to keep the
+	// blocks short so they fit on the shelves better.
+	int cellWidth = width + 2;
+	int cellHeight = height + 2;
+	int columns = min(frames, SIZE / cellWidth);
+	int rows = (frames + columns - 1) / columns;
+	if(rows * cellHeight > SIZE)
+		return 0;
+	
+	int x = 0;
+	int y = 0;
+	Atlas &atlas = Allocate(columns * cellWidth, rows * cellHeight, x, y);
+	
+	// Copy each frame, along with its border, into the atlas.
+	glBindTexture(GL_TEXTURE_2D_ARRAY, atlas.texture);
+	vector<uint32_t> cell(cellWidth * cellHeight);
+	for(int frame = 0; frame < frames; ++frame)
+	{
+		for(int cy = 0; cy < cellHeight; ++cy)
+		{
+			const uint32_t *in = buffer.Begin(min(max(cy - 1, 0), height - 1), frame);
+			uint32_t *out = &cell[cy * cellWidth];
+			out[0] = in[0];
+			copy(in, in + width, out + 1);
+			out[cellWidth - 1] = in[width - 1];
+		}
+		int cx = x + (frame % columns) * cellWidth;
+		int cy = y + (frame / columns) * cellHeight;
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, cx, cy, 0, cellWidth, cellHeight, 1,
+			GL_BGRA, GL_UNSIGNED_BYTE, cell.data());
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	
+	layout.rect[0] = (x + 1.f) / SIZE;
+	layout.rect[1] = (y + 1.f) / SIZE;
+	layout.rect[2] = static_cast<float>(width) / SIZE;
+	layout.rect[3] = static_cast<float>(height) / SIZE;
+	layout.grid[0] = columns;
+	layout.grid[1] = static_cast<float>(cellWidth) / SIZE;
+	layout.grid[2] = static_cast<float>(cellHeight) / SIZE;
+	
+	return atlas.texture;
+}
@@ -0,0 +1,39 @@
+/* SpriteAtlas.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef SPRITE_ATLAS_H_
+#define SPRITE_ATLAS_H_
+
+#include "Sprite.h"
+
+#include <cstdint>
+
+class ImageBuffer;
+
+
+
+// Class for packing small sprites (projectiles, effects, and so on) into large
+// shared textures, so that many different sprites can be drawn with a single
+// draw call. Each sprite's frames are laid out in a grid, with a one pixel
+// border around each frame that repeats the frame's edge pixels, so that
+// linear filtering never picks up any pixels from the neighboring frames.
+class SpriteAtlas {
+public:
+	// If the given image is small enough, copy all its frames into an atlas,
+	// fill in the given layout, and return the atlas texture. Otherwise, return
+	// zero. This must be called from the thread that owns the OpenGL context.
+	static uint32_t Add(const ImageBuffer &buffer, bool is2x, Sprite::Layout &layout);
+};
+
+
+
+#endif
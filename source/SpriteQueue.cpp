@@ -15,14 +15,33 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "ImageBuffer.h"
 #include "ImageSet.h"
 #include "Mask.h"
+#include "Preferences.h"
 #include "Sprite.h"
 #include "SpriteSet.h"
 
+#include "gl_header.h"
+
 #include <algorithm>
 #include <functional>
 
 using namespace std;
 
+namespace {
+	// Sprites that have been drawn within this many frames are never unloaded,
+	// even if that means going over the memory budget.
+	const int MIN_AGE = 120;
+	// When over budget, only check for sprites to unload this often.
+	const int EVICT_INTERVAL = 60;
+	// Wait this many frames before deleting an unloaded texture, so that any
+	// draw list that was filled in before it was unloaded has been drawn.
+	const int DELETE_DELAY = 3;
+	
+	size_t Budget()
+	{
+		return static_cast<size_t>(max(0, Preferences::TextureMemory())) << 20;
+	}
+}
+
 
 
 // Constructor, which allocates worker threads.
@@ -52,25 +71,35 @@ SpriteQueue::~SpriteQueue()
 // Add a sprite to load.
 void SpriteQueue::Add(const shared_ptr<ImageSet> &images)
 {
-	{
-		lock_guard<mutex> lock(readMutex);
-		// Do nothing if we are destroying the queue already.
-		if(added < 0)
-			return;
-		
-		toRead.push(images);
-		++added;
-	}
-	readCondition.notify_one();
+	Defer(images);
+	Read(entries[SpriteSet::Get(images->Name())]);
 }
 
 
 
-// Unload the texture for the given sprite (to free up memory).
-void SpriteQueue::Unload(const string &name)
+// Add a sprite, but do not load it until it is drawn or preloaded.
+void SpriteQueue::Defer(const shared_ptr<ImageSet> &images)
 {
-	unique_lock<mutex> lock(loadMutex);
-	toUnload.push(name);
+	Entry &entry = entries[SpriteSet::Get(images->Name())];
+	entry.sprite = SpriteSet::Modify(images->Name());
+	entry.images = images;
+}
+
+
+
+// Begin loading the given sprite, if it is not loaded already, because it
+// will probably be drawn soon.
+void SpriteQueue::Preload(const Sprite *sprite)
+{
+	auto it = entries.find(sprite);
+	if(it == entries.end())
+		return;
+	
+	// Count this as a use, so the sprite will not be unloaded right away.
+	Entry &entry = it->second;
+	entry.lastUse = frame;
+	if(!entry.isResident && !entry.isQueued)
+		Read(entry);
 }
 
 
@@ -104,6 +133,74 @@ void SpriteQueue::Finish()
 
 
 
+// Upload more images, and update which sprites are resident. This must be
+// called once per frame, from the main thread.
+void SpriteQueue::Step()
+{
+	++frame;
+	{
+		unique_lock<mutex> lock(loadMutex);
+		DoLoad(lock);
+	}
+	
+	// Delete any unloaded textures that can no longer be drawn.
+	while(!toDelete.empty() && toDelete.front().first + DELETE_DELAY <= frame)
+	{
+		glDeleteTextures(1, &toDelete.front().second);
+		toDelete.pop();
+	}
+	
+	// Note which sprites have been drawn since the last frame, and start loading
+	// any of them that are not loaded. Until they are, they draw as nothing.
+	for(auto &it : entries)
+	{
+		Entry &entry = it.second;
+		if(!entry.sprite->CheckUsed())
+			continue;
+		
+		entry.lastUse = frame;
+		if(!entry.isResident && !entry.isQueued)
+			Read(entry);
+	}
+	
+	size_t budget = Budget();
+	if(residentBytes <= budget || frame % EVICT_INTERVAL)
+		return;
+	
+	// Unload the sprites that have gone the longest without being drawn until
+	// the rest of them fit in the budget. (Sprites in an atlas do not count
+	// toward the budget, and are never unloaded.)
+	vector<pair<int, Entry *>> unused;
+	for(auto &it : entries)
+		if(it.second.isResident && it.second.sprite->TextureBytes() && frame - it.second.lastUse > MIN_AGE)
+			unused.emplace_back(it.second.lastUse, &it.second);
+	sort(unused.begin(), unused.end(),
+		[](const pair<int, Entry *> &a, const pair<int, Entry *> &b) { return a.first < b.first; });
+	
+	vector<uint32_t> names;
+	for(const pair<int, Entry *> &it : unused)
+	{
+		if(residentBytes <= budget)
+			break;
+		
+		residentBytes -= it.second->sprite->TextureBytes();
+		it.second->sprite->UnloadTextures(names);
+		it.second->isResident = false;
+	}
+	for(uint32_t name : names)
+		toDelete.emplace(frame, name);
+}
+
+
+
+// Get the number of bytes of texture memory the sprites are using.
+size_t SpriteQueue::ResidentBytes() const
+{
+	return residentBytes;
+}
+
+
+
 // Thread entry point.
 void SpriteQueue::operator()()
 {
@@ -145,18 +242,26 @@ void SpriteQueue::operator()()
 
 
 
-double SpriteQueue::DoLoad(unique_lock<mutex> &lock)
+// Queue up the given sprite to be read from disk.
+void SpriteQueue::Read(Entry &entry)
 {
-	while(!toUnload.empty())
 	{
-		Sprite *sprite = SpriteSet::Modify(toUnload.front());
-		toUnload.pop();
+		lock_guard<mutex> lock(readMutex);
+		// Do nothing if we are destroying the queue already.
+		if(added < 0)
+			return;
 		
-		lock.unlock();
-		sprite->Unload();
-		lock.lock();
+		toRead.push(entry.images);
+		++added;
 	}
-	
+	entry.isQueued = true;
+	readCondition.notify_one();
+}
+
+
+
+double SpriteQueue::DoLoad(unique_lock<mutex> &lock)
+{
 	for(int i = 0; !toLoad.empty() && i < 100; ++i)
 	{
 		// Extract the one item we should work on uploading right now.
@@ -166,7 +271,14 @@ double SpriteQueue::DoLoad(unique_lock<mutex> &lock)
 		// It's now safe to modify the lists.
 		lock.unlock();
 		
-		imageSet->Upload(SpriteSet::Modify(imageSet->Name()));
+		// If this sprite has never been drawn, only upload its textures if there
+		// is room for them in the budget. Otherwise, they will be loaded again
+		// once they are needed.
+		Entry &entry = entries[SpriteSet::Get(imageSet->Name())];
+		entry.isQueued = false;
+		entry.isResident = (entry.lastUse >= 0 || residentBytes < Budget());
+		imageSet->Upload(entry.sprite, entry.isResident);
+		residentBytes += entry.sprite->TextureBytes();
 		
 		lock.lock();
 		++completed;
@@ -14,12 +14,14 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #define SPRITE_QUEUE_H_
 
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <queue>
-#include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 class ImageBuffer;
@@ -30,7 +32,11 @@ class Sprite;
 
 
 // Class for queuing up a list of sprites to be loaded from the disk, with a set of
-// worker threads that begins loading them as soon as they are added.
+// worker threads that begins loading them as soon as they are added. This also
+// manages which sprites' textures are resident on the GPU: once per frame, it
+// reloads any unloaded sprite that has been drawn since the last frame, and if
+// the textures take up more memory than the user's budget allows, it unloads
+// the ones that have gone the longest without being drawn.
 class SpriteQueue {
 public:
 	SpriteQueue();
@@ -38,18 +44,42 @@ public:
 	
 	// Add a sprite to load.
 	void Add(const std::shared_ptr<ImageSet> &images);
-	// Unload the texture for the given sprite (to free up memory).
-	void Unload(const std::string &name);
+	// Add a sprite, but do not load it until it is drawn or preloaded.
+	void Defer(const std::shared_ptr<ImageSet> &images);
+	// Begin loading the given sprite, if it is not loaded already, because it
+	// will probably be drawn soon.
+	void Preload(const Sprite *sprite);
 	// Upload more iamges and find out our percent completion.
 	double Progress();
 	// Finish loading.
 	void Finish();
+	// Upload more images, and update which sprites are resident. This must be
+	// called once per frame, from the main thread.
+	void Step();
+	// Get the number of bytes of texture memory the sprites are using.
+	size_t ResidentBytes() const;
 	
 	// Thread entry point.
 	void operator()();
 	
 	
 private:
+	class Entry {
+	public:
+		Sprite *sprite = nullptr;
+		std::shared_ptr<ImageSet> images;
+		// Whether this sprite's textures are uploaded, or will be once it is
+		// done being read from disk.
+		bool isResident = false;
+		bool isQueued = false;
+		// The frame in which this sprite was last drawn, or -1 if never.
+		int lastUse = -1;
+	};
+	
+	
+private:
+	// Queue up the given sprite to be read from disk.
+	void Read(Entry &entry);
 	double DoLoad(std::unique_lock<std::mutex> &lock);
 	
 	
@@ -66,8 +96,14 @@ private:
 	std::condition_variable loadCondition;
 	int completed = 0;
 	
-	// These sprites must be unloaded to reclaim GPU memory.
-	std::queue<std::string> toUnload;
+	// Every sprite that this queue knows how to load. The residency state is
+	// only ever accessed from the main thread, so it needs no lock.
+	std::map<const Sprite *, Entry> entries;
+	int frame = 0;
+	size_t residentBytes = 0;
+	// Textures that have been unloaded, and the frame they were unloaded in.
+	// They are only deleted once no draw list can still refer to them.
+	std::queue<std::pair<int, uint32_t>> toDelete;
 	
 	// Worker threads for loading sprites from disk.
 	std::vector<std::thread> threads;
@@ -15,6 +15,8 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Sprite.h"
 
 #include <map>
+#include <tuple>
+#include <utility>
 
 using namespace std;
 
@@ -35,6 +37,6 @@ Sprite *SpriteSet::Modify(const string &name)
 {
 	auto it = sprites.find(name);
 	if(it == sprites.end())
-		it = sprites.insert(make_pair(name, Sprite(name))).first;
+		it = sprites.emplace(piecewise_construct, forward_as_tuple(name), forward_as_tuple(name)).first;
 	return &it->second;
 }
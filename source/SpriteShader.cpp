@@ -17,6 +17,9 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Shader.h"
 #include "Sprite.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <string>
 #include <vector>
 
 using namespace std;
@@ -24,16 +27,27 @@ using namespace std;
 namespace {
 	Shader shader;
 	GLint scaleI;
-	GLint frameI;
-	GLint frameCountI;
-	GLint positionI;
-	GLint transformI;
-	GLint blurI;
-	GLint clipI;
-	GLint alphaI;
+	GLint useBlurI;
+	
+	// Per-sprite attributes. When drawing one sprite at a time these are set as
+	// constant vertex attributes; when drawing a batch they are read from the
+	// instance buffer, which holds the SpriteShader::Item array verbatim.
+	GLint swizzleA;
+	GLint frameA;
+	GLint positionA;
+	GLint transformA;
+	GLint blurA;
+	GLint clipA;
+	GLint rectA;
+	GLint gridA;
 	
 	GLuint vao;
 	GLuint vbo;
+	GLuint instanceVao;
+	GLuint instanceVbo;
+	// Instanced drawing needs glVertexAttribDivisor(), which is only in core
+	// OpenGL as of version 3.3. Without it, batches are drawn one by one.
+	bool useInstancing = false;
 
 	const vector<vector<GLint>> SWIZZLE = {
 		{GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA}, // red + yellow markings (republic)
@@ -46,6 +60,40 @@ namespace {
 		{GL_BLUE, GL_ZERO, GL_ZERO, GL_ALPHA},  // red only (cloaked)
 		{GL_ZERO, GL_ZERO, GL_ZERO, GL_ALPHA}  // black only (outline)
 	};
+	
+	// Point the per-instance attributes at the given item in the instance
+	// buffer. (Base instances are not available until OpenGL 4.2.)
+	void SetInstanceOffset(size_t first)
+	{
+		const char *base = reinterpret_cast<const char *>(first * sizeof(SpriteShader::Item));
+		const GLsizei stride = sizeof(SpriteShader::Item);
+		glVertexAttribIPointer(swizzleA, 1, GL_UNSIGNED_INT, stride, base + offsetof(SpriteShader::Item, swizzle));
+		glVertexAttribPointer(frameA, 2, GL_FLOAT, GL_FALSE, stride, base + offsetof(SpriteShader::Item, frame));
+		glVertexAttribPointer(positionA, 2, GL_FLOAT, GL_FALSE, stride, base + offsetof(SpriteShader::Item, position));
+		glVertexAttribPointer(transformA, 4, GL_FLOAT, GL_FALSE, stride, base + offsetof(SpriteShader::Item, transform));
+		glVertexAttribPointer(blurA, 2, GL_FLOAT, GL_FALSE, stride, base + offsetof(SpriteShader::Item, blur));
+		glVertexAttribPointer(clipA, 2, GL_FLOAT, GL_FALSE, stride, base + offsetof(SpriteShader::Item, clip));
+		glVertexAttribPointer(rectA, 4, GL_FLOAT, GL_FALSE, stride, base + offsetof(SpriteShader::Item, rect));
+		glVertexAttribPointer(gridA, 3, GL_FLOAT, GL_FALSE, stride, base + offsetof(SpriteShader::Item, grid));
+	}
+	
+	// Set the per-sprite attributes to the given item's values and draw it.
+	// This does not change any other state, so when drawing many items without
+	// instancing the texture only needs to be bound once for each run of them.
+	void DrawSingle(const SpriteShader::Item &item)
+	{
+		// Bounds check for the swizzle value:
+		glVertexAttribI1ui(swizzleA, item.swizzle >= SWIZZLE.size() ? 0 : item.swizzle);
+		glVertexAttrib2f(frameA, item.frame, item.frameCount);
+		glVertexAttrib2fv(positionA, item.position);
+		glVertexAttrib4fv(transformA, item.transform);
+		glVertexAttrib2fv(blurA, item.blur);
+		glVertexAttrib2f(clipA, item.clip, item.alpha);
+		glVertexAttrib4fv(rectA, item.rect);
+		glVertexAttrib3fv(gridA, item.grid);
+		
+		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	}
 }
 
 
@@ -53,48 +101,90 @@ namespace {
 // Initialize the shaders.
 void SpriteShader::Init()
 {
-	static const char *vertexCode =
+	static const string vertexCode =
 		"uniform vec2 scale;\n"
-		"uniform vec2 position;\n"
-		"uniform mat2 transform;\n"
-		"uniform vec2 blur;\n"
-		"uniform float clip;\n"
+		"uniform float useBlur;\n"
 		
 		"in vec2 vert;\n"
+		"in uint swizzle;\n"
+		"in vec2 frame;\n"
+		"in vec2 position;\n"
+		"in vec4 transform;\n"
+		"in vec2 blur;\n"
+		"in vec2 clip;\n"
+		"in vec4 rect;\n"
+		"in vec3 grid;\n"
+		
 		"out vec2 fragTexCoord;\n"
+		"flat out vec2 fragFrame;\n"
+		"flat out vec2 fragBlur;\n"
+		"flat out float fragAlpha;\n"
+		"flat out uint fragSwizzle;\n"
+		"flat out vec4 fragRect;\n"
+		"flat out vec3 fragGrid;\n"
 		
 		"void main() {\n"
-		"  vec2 blurOff = 2 * vec2(vert.x * abs(blur.x), vert.y * abs(blur.y));\n"
-		"  gl_Position = vec4((transform * (vert + blurOff) + position) * scale, 0, 1);\n"
+		"  fragBlur = useBlur * blur;\n"
+		"  vec2 blurOff = 2 * vec2(vert.x * abs(fragBlur.x), vert.y * abs(fragBlur.y));\n"
+		"  gl_Position = vec4((mat2(transform) * (vert + blurOff) + position) * scale, 0, 1);\n"
 		"  vec2 texCoord = vert + vec2(.5, .5);\n"
-		"  fragTexCoord = vec2(texCoord.x, max(clip, texCoord.y)) + blurOff;\n"
+		// Clipping has the opposite sense in the shader.
+		"  fragTexCoord = vec2(texCoord.x, max(1. - clip.x, texCoord.y)) + blurOff;\n"
+		"  fragFrame = frame;\n"
+		"  fragAlpha = clip.y;\n"
+		// Bounds check for the swizzle value:
+		"  fragSwizzle = (swizzle < " + to_string(SWIZZLE.size()) + "u) ? swizzle : 0u;\n"
+		"  fragRect = rect;\n"
+		"  fragGrid = grid;\n"
 		"}\n";
 	
-	static const char *fragmentCode =
+	// The color swizzles are applied as matrices rather than as texture state,
+	// so that sprites with different swizzles can be drawn in one batch. The
+	// texture coordinates are clamped to the frame, because if this sprite is
+	// in an atlas, the texture's own edge clamping does not apply.
+	static const string fragmentCode =
 		"uniform sampler2DArray tex;\n"
-		"uniform float frame;\n"
-		"uniform float frameCount;\n"
-		"uniform vec2 blur;\n"
-		"uniform float alpha;\n"
+		"uniform mat4 swizzleMatrix[" + to_string(SWIZZLE.size()) + "];\n"
 		"const int range = 5;\n"
 		
 		"in vec2 fragTexCoord;\n"
+		"flat in vec2 fragFrame;\n"
+		"flat in vec2 fragBlur;\n"
+		"flat in float fragAlpha;\n"
+		"flat in uint fragSwizzle;\n"
+		"flat in vec4 fragRect;\n"
+		"flat in vec3 fragGrid;\n"
 		
 		"out vec4 finalColor;\n"
 		
+		// Get the texture coordinates of the given frame's top left corner, and
+		// the layer that it is in.
+		"vec3 Corner(float frame) {\n"
+		"  if(fragGrid.x == 0)\n"
+		"    return vec3(fragRect.xy, frame);\n"
+		"  float row = floor((frame + .5) / fragGrid.x);\n"
+		"  return vec3(fragRect.xy + vec2(frame - row * fragGrid.x, row) * fragGrid.yz, 0);\n"
+		"}\n"
+		
+		"vec4 Sample(vec2 coord, vec3 corner) {\n"
+		"  return texture(tex, vec3(corner.xy + clamp(coord, 0., 1.) * fragRect.zw, corner.z));\n"
+		"}\n"
+		
 		"void main() {\n"
-		"  float first = floor(frame);\n"
-		"  float second = mod(ceil(frame), frameCount);\n"
-		"  float fade = frame - first;\n"
+		"  float frame = fragFrame.x;\n"
+		"  float fade = frame - floor(frame);\n"
+		"  vec3 first = Corner(floor(frame));\n"
+		"  vec3 second = Corner(mod(ceil(frame), fragFrame.y));\n"
+		"  vec2 blur = fragBlur;\n"
 		"  vec4 color;\n"
 		"  if(blur.x == 0 && blur.y == 0)\n"
 		"  {\n"
 		"    if(fade != 0)\n"
 		"      color = mix(\n"
-		"        texture(tex, vec3(fragTexCoord, first)),\n"
-		"        texture(tex, vec3(fragTexCoord, second)), fade);\n"
+		"        Sample(fragTexCoord, first),\n"
+		"        Sample(fragTexCoord, second), fade);\n"
 		"    else\n"
-		"      color = texture(tex, vec3(fragTexCoord, first));\n"
+		"      color = Sample(fragTexCoord, first);\n"
 		"  }\n"
 		"  else\n"
 		"  {\n"
@@ -106,27 +196,43 @@ void SpriteShader::Init()
 		"      vec2 coord = fragTexCoord + (blur * i) / range;\n"
 		"      if(fade != 0)\n"
 		"        color += scale * mix(\n"
-		"          texture(tex, vec3(coord, first)),\n"
-		"          texture(tex, vec3(coord, second)), fade);\n"
+		"          Sample(coord, first),\n"
+		"          Sample(coord, second), fade);\n"
 		"      else\n"
-		"        color += scale * texture(tex, vec3(coord, first));\n"
+		"        color += scale * Sample(coord, first);\n"
 		"    }\n"
 		"  }\n"
-		"  finalColor = color * alpha;\n"
+		"  finalColor = (swizzleMatrix[fragSwizzle] * color) * fragAlpha;\n"
 		"}\n";
 	
-	shader = Shader(vertexCode, fragmentCode);
+	shader = Shader(vertexCode.c_str(), fragmentCode.c_str());
 	scaleI = shader.Uniform("scale");
-	frameI = shader.Uniform("frame");
-	frameCountI = shader.Uniform("frameCount");
-	positionI = shader.Uniform("position");
-	transformI = shader.Uniform("transform");
-	blurI = shader.Uniform("blur");
-	clipI = shader.Uniform("clip");
-	alphaI = shader.Uniform("alpha");
+	useBlurI = shader.Uniform("useBlur");
+	swizzleA = shader.Attrib("swizzle");
+	frameA = shader.Attrib("frame");
+	positionA = shader.Attrib("position");
+	transformA = shader.Attrib("transform");
+	blurA = shader.Attrib("blur");
+	clipA = shader.Attrib("clip");
+	rectA = shader.Attrib("rect");
+	gridA = shader.Attrib("grid");
+	
+	// Convert each swizzle into a (column-major) matrix that selects the
+	// given source channel for each output channel.
+	vector<GLfloat> matrices(16 * SWIZZLE.size(), 0.f);
+	for(size_t i = 0; i < SWIZZLE.size(); ++i)
+		for(int row = 0; row < 4; ++row)
+		{
+			GLint source = SWIZZLE[i][row];
+			int column = (source == GL_RED) ? 0 : (source == GL_GREEN) ? 1
+				: (source == GL_BLUE) ? 2 : (source == GL_ALPHA) ? 3 : -1;
+			if(column >= 0)
+				matrices[16 * i + 4 * column + row] = 1.f;
+		}
 	
 	glUseProgram(shader.Object());
 	glUniform1i(shader.Uniform("tex"), 0);
+	glUniformMatrix4fv(shader.Uniform("swizzleMatrix"), SWIZZLE.size(), GL_FALSE, matrices.data());
 	glUseProgram(0);
 	
 	// Generate the vertex data for drawing sprites.
@@ -147,6 +253,31 @@ void SpriteShader::Init()
 	glEnableVertexAttribArray(shader.Attrib("vert"));
 	glVertexAttribPointer(shader.Attrib("vert"), 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
 	
+#ifdef __APPLE__
+	useInstancing = true;
+#else
+	useInstancing = GLEW_VERSION_3_3;
+#endif
+	if(useInstancing)
+	{
+		// The second vertex array shares the quad, but reads all the other
+		// attributes once per instance from a streamed buffer of items.
+		glGenVertexArrays(1, &instanceVao);
+		glBindVertexArray(instanceVao);
+		
+		glEnableVertexAttribArray(shader.Attrib("vert"));
+		glVertexAttribPointer(shader.Attrib("vert"), 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
+		
+		glGenBuffers(1, &instanceVbo);
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+		for(GLint attrib : {swizzleA, frameA, positionA, transformA, blurA, clipA, rectA, gridA})
+		{
+			glEnableVertexAttribArray(attrib);
+			glVertexAttribDivisor(attrib, 1);
+		}
+		SetInstanceOffset(0);
+	}
+	
 	// unbind the VBO and VAO
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
@@ -160,7 +291,10 @@ void SpriteShader::Draw(const Sprite *sprite, const Point &position, float zoom,
 		return;
 	
 	Item item;
-	item.texture = sprite->Texture();
+	const Sprite::Layout *layout;
+	item.texture = sprite->Texture(Screen::IsHighResolution(), layout);
+	copy(layout->rect, layout->rect + 4, item.rect);
+	copy(layout->grid, layout->grid + 3, item.grid);
 	item.frame = frame;
 	item.frameCount = sprite->Frames();
 	// Position.
@@ -193,24 +327,55 @@ void SpriteShader::Bind()
 void SpriteShader::Add(const Item &item, bool withBlur)
 {
 	glBindTexture(GL_TEXTURE_2D_ARRAY, item.texture);
-
-	glUniform1f(frameI, item.frame);
-	glUniform1f(frameCountI, item.frameCount);
-	glUniform2fv(positionI, 1, item.position);
-	glUniformMatrix2fv(transformI, 1, false, item.transform);
+	
 	// Special case: check if the blur should be applied or not.
-	static const float UNBLURRED[2] = {0.f, 0.f};
-	glUniform2fv(blurI, 1, withBlur ? item.blur : UNBLURRED);
-	// Clipping has the opposite sense in the shader.
-	glUniform1f(clipI, 1.f - item.clip);
-	glUniform1f(alphaI, item.alpha);
-	
-	// Bounds check for the swizzle value:
-	int swizzle = (static_cast<size_t>(item.swizzle) >= SWIZZLE.size() ? 0 : item.swizzle);
-	// Set the color swizzle.
-	glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, SWIZZLE[swizzle].data());
-	
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	glUniform1f(useBlurI, withBlur);
+	DrawSingle(item);
+}
+
+
+
+// Draw a list of items, in order. Each run of consecutive items that use the
+// same texture is drawn with a single instanced draw call. The swizzle, blur,
+// and everything else that differs between the items is per-instance data, so
+// the only state that changes between runs is which texture is bound.
+void SpriteShader::Add(const vector<Item> &items, bool withBlur)
+{
+	if(items.empty())
+		return;
+	
+	glUniform1f(useBlurI, withBlur);
+	if(useInstancing)
+	{
+		glBindVertexArray(instanceVao);
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+		glBufferData(GL_ARRAY_BUFFER, items.size() * sizeof(Item), items.data(), GL_STREAM_DRAW);
+	}
+	
+	for(size_t first = 0; first < items.size(); )
+	{
+		uint32_t texture = items[first].texture;
+		size_t last = first + 1;
+		while(last < items.size() && items[last].texture == texture)
+			++last;
+		
+		glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+		if(useInstancing)
+		{
+			SetInstanceOffset(first);
+			glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, last - first);
+		}
+		else
+			for(size_t i = first; i < last; ++i)
+				DrawSingle(items[i]);
+		first = last;
+	}
+	
+	if(useInstancing)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindVertexArray(vao);
+	}
 }
 
 
@@ -219,7 +384,4 @@ void SpriteShader::Unbind()
 {
 	glBindVertexArray(0);
 	glUseProgram(0);
-	
-	// Reset the swizzle.
-	glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, SWIZZLE[0].data());
 }
@@ -17,6 +17,7 @@ class Sprite;
 class Point;
 
 #include <cstdint>
+#include <vector>
 
 
 
@@ -38,6 +39,9 @@ public:
 		float blur[2] = {0.f, 0.f};
 		float clip = 1.f;
 		float alpha = 1.f;
+		// Where the frames are in the texture (see Sprite::Layout).
+		float rect[4] = {0.f, 0.f, 1.f, 1.f};
+		float grid[3] = {0.f, 0.f, 0.f};
 	};
 	
 	
@@ -50,6 +54,9 @@ public:
 	
 	static void Bind();
 	static void Add(const Item &item, bool withBlur = false);
+	// Draw a list of items, batching consecutive items with the same texture.
+	// Small sprites share atlas textures, so they can be batched together.
+	static void Add(const std::vector<Item> &items, bool withBlur = false);
 	static void Unbind();
 };
 
@@ -14,7 +14,6 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Angle.h"
 #include "Body.h"
-#include "DrawList.h"
 #include "pi.h"
 #include "Point.h"
 #include "Preferences.h"
@@ -30,7 +29,8 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 using namespace std;
 
 namespace {
-	const int TILE_SIZE = 256;
+	// Height of each of the bands that the stars are sorted into.
+	const int BAND_SIZE = 256;
 	// The star field tiles in 4000 pixel increments. Have the tiling of the haze
 	// field be as different from that as possible. (Note: this may need adjusting
 	// in the future if monitors larger than this width ever become commonplace.)
@@ -111,33 +111,52 @@ void StarField::Draw(const Point &pos, const Point &vel, double zoom) const
 	glUniform1f(elongationI, length * zoom);
 	glUniform1f(brightnessI, min(1., pow(zoom, .5)));
 	
-	// Stars this far beyond the border may still overlap the screen.
-	double borderX = fabs(vel.X()) + 1.;
-	double borderY = fabs(vel.Y()) + 1.;
+	// Stars this far beyond the border may still overlap the screen. Any star
+	// outside of these bounds is wrapped around to the other side, so the
+	// border must be big enough for the largest, most elongated star.
+	Point border = Point(fabs(vel.X()) + 4., fabs(vel.Y()) + 4.) * max(1., zoom);
 	// Find the absolute bounds of the star field we must draw.
-	int minX = pos.X() + (Screen::Left() - borderX) / zoom;
-	int minY = pos.Y() + (Screen::Top() - borderY) / zoom;
-	int maxX = pos.X() + (Screen::Right() + borderX) / zoom;
-	int maxY = pos.Y() + (Screen::Bottom() + borderY) / zoom;
-	// Round down to the start of the nearest tile.
-	minX &= ~(TILE_SIZE - 1l);
-	minY &= ~(TILE_SIZE - 1l);
+	Point minimum = pos + (Screen::TopLeft() - border) / zoom;
+	Point maximum = pos + (Screen::BottomRight() + border) / zoom;
 	
-	for(int gy = minY; gy < maxY; gy += TILE_SIZE)
-		for(int gx = minX; gx < maxX; gx += TILE_SIZE)
+	// The vertex shader wraps each star around so that it lands in the copy of
+	// the pattern that begins at the given origin. Unless the view is zoomed
+	// out far enough to see more than one copy, the whole field is one draw.
+	double width = widthMod + 1.;
+	GLfloat origin[2] = {
+		static_cast<float>(minimum.X() - width * floor(minimum.X() / width)),
+		static_cast<float>(minimum.Y() - width * floor(minimum.Y() / width))};
+	glUniform2fv(originI, 1, origin);
+	glUniform1f(widthI, width);
+	
+	int bands = bandIndex.size() - 1;
+	for(double y = minimum.Y(); y < maximum.Y(); y += width)
+	{
+		// Only draw the bands of the pattern that this copy of it overlaps.
+		// They may wrap around from the bottom of the pattern to the top.
+		int first = origin[1] / BAND_SIZE;
+		int last = (origin[1] + min(width, maximum.Y() - y)) / BAND_SIZE + 1;
+		if(last - first >= bands)
+		{
+			first = 0;
+			last = bands;
+		}
+		
+		for(double x = minimum.X(); x < maximum.X(); x += width)
 		{
-			Point off = Point(gx, gy) - pos;
+			Point off = Point(x, y) - pos;
 			GLfloat translate[2] = {
 				static_cast<float>(off.X()),
 				static_cast<float>(off.Y())
 			};
 			glUniform2fv(translateI, 1, translate);
 			
-			int index = (gx & widthMod) / TILE_SIZE + ((gy & widthMod) / TILE_SIZE) * tileCols;
-			int first = 6 * tileIndex[index];
-			int count = 6 * tileIndex[index + 1] - first;
-			glDrawArrays(GL_TRIANGLES, first, count);
+			int end = bandIndex[min(last, bands)];
+			glDrawArrays(GL_TRIANGLES, 6 * bandIndex[first], 6 * (end - bandIndex[first]));
+			if(last > bands)
+				glDrawArrays(GL_TRIANGLES, 0, 6 * bandIndex[last - bands]);
 		}
+	}
 	
 	glBindVertexArray(0);
 	glUseProgram(0);
@@ -146,9 +165,8 @@ void StarField::Draw(const Point &pos, const Point &vel, double zoom) const
 	if(!Preferences::Has("Draw background haze"))
 		return;
 	
-	DrawList drawList;
-	drawList.Clear(0, zoom);
-	drawList.SetCenter(pos);
+	hazeList.Clear(0, zoom);
+	hazeList.SetCenter(pos);
 	
 	// Any object within this range must be drawn. Some haze sprites may repeat
 	// more than once if the view covers a very large area.
@@ -167,9 +185,9 @@ void StarField::Draw(const Point &pos, const Point &vel, double zoom) const
 		// Draw any instances of this haze that are on screen.
 		for(double y = startY; y < bottomRight.Y(); y += HAZE_WRAP)
 			for(double x = startX; x < bottomRight.X(); x += HAZE_WRAP)
-				drawList.Add(it, Point(x, y));
+				hazeList.Add(it, Point(x, y));
 	}
-	drawList.Draw();
+	hazeList.Draw();
 }
 
 
@@ -179,6 +197,8 @@ void StarField::SetUpGraphics()
 	static const char *vertexCode =
 		"uniform mat2 rotate;\n"
 		"uniform vec2 translate;\n"
+		"uniform vec2 origin;\n"
+		"uniform float width;\n"
 		"uniform vec2 scale;\n"
 		"uniform float elongation;\n"
 		"uniform float brightness;\n"
@@ -193,7 +213,8 @@ void StarField::SetUpGraphics()
 		"  fragmentAlpha = brightness * (4. / (4. + elongation)) * size * .2 + .05;\n"
 		"  coord = vec2(sin(corner), cos(corner));\n"
 		"  vec2 elongated = vec2(coord.x * size, coord.y * (size + elongation));\n"
-		"  gl_Position = vec4((rotate * elongated + translate + offset) * scale, 0, 1);\n"
+		"  vec2 wrapped = mod(offset - origin, width);\n"
+		"  gl_Position = vec4((rotate * elongated + translate + wrapped) * scale, 0, 1);\n"
 		"}\n";
 
 	static const char *fragmentCode =
@@ -224,6 +245,8 @@ void StarField::SetUpGraphics()
 	rotateI = shader.Uniform("rotate");
 	elongationI = shader.Uniform("elongation");
 	translateI = shader.Uniform("translate");
+	originI = shader.Uniform("origin");
+	widthI = shader.Uniform("width");
 	brightnessI = shader.Uniform("brightness");
 }
 
@@ -232,14 +255,13 @@ void StarField::SetUpGraphics()
 void StarField::MakeStars(int stars, int width)
 {
 	// We can only work with power-of-two widths above 256.
-	if(width < TILE_SIZE || (width & (width - 1)))
+	if(width < BAND_SIZE || (width & (width - 1)))
 		return;
 	
 	widthMod = width - 1;
 	
-	tileCols = (width / TILE_SIZE);
-	tileIndex.clear();
-	tileIndex.resize(tileCols * tileCols, 0);
+	bandIndex.clear();
+	bandIndex.resize(width / BAND_SIZE, 0);
 	
 	vector<int> off;
 	static const int MAX_OFF = 50;
@@ -258,7 +280,7 @@ void StarField::MakeStars(int stars, int width)
 		}
 	
 	// Generate random points in a temporary vector.
-	// Keep track of how many fall into each tile, for sorting out later.
+	// Keep track of how many fall into each band, for sorting out later.
 	vector<int> temp;
 	temp.reserve(2 * stars);
 	
@@ -276,33 +298,31 @@ void StarField::MakeStars(int stars, int width)
 		}
 		temp.push_back(x);
 		temp.push_back(y);
-		int index = (x / TILE_SIZE) + (y / TILE_SIZE) * tileCols;
-		++tileIndex[index];
+		++bandIndex[y / BAND_SIZE];
 	}
 	
-	// Accumulate item counts so that tileIndex[i] is the index in the array of
-	// the first star that falls within tile i, and tileIndex.back() == stars.
-	tileIndex.insert(tileIndex.begin(), 0);
-	tileIndex.pop_back();
-	partial_sum(tileIndex.begin(), tileIndex.end(), tileIndex.begin());
+	// Accumulate item counts so that bandIndex[i] is the index in the array of
+	// the first star that falls within band i, and bandIndex.back() == stars.
+	bandIndex.insert(bandIndex.begin(), 0);
+	bandIndex.pop_back();
+	partial_sum(bandIndex.begin(), bandIndex.end(), bandIndex.begin());
 	
-	// Each star consists of five vertices, each with four data elements.
+	// Each star consists of six vertices, each with four data elements.
 	vector<GLfloat> data(6 * 4 * stars, 0.f);
 	for(auto it = temp.begin(); it != temp.end(); )
 	{
-		// Figure out what tile this star is in.
 		int x = *it++;
 		int y = *it++;
-		int index = (x / TILE_SIZE) + (y / TILE_SIZE) * tileCols;
+		int band = y / BAND_SIZE;
 		
 		// Randomize its sub-pixel position and its size / brightness.
 		int random = Random::Int(4096);
-		float fx = (x & (TILE_SIZE - 1)) + (random & 15) * 0.0625f;
-		float fy = (y & (TILE_SIZE - 1)) + (random >> 8) * 0.0625f;
+		float fx = x + (random & 15) * 0.0625f;
+		float fy = y + (random >> 8) * 0.0625f;
 		float size = (((random >> 4) & 15) + 20) * 0.0625f;
 		
 		// Fill in the data array.
-		auto dataIt = data.begin() + 6 * 4 * tileIndex[index]++;
+		auto dataIt = data.begin() + 6 * 4 * bandIndex[band]++;
 		const float CORNER[6] = {
 			static_cast<float>(0. * PI),
 			static_cast<float>(.5 * PI),
@@ -319,9 +339,9 @@ void StarField::MakeStars(int stars, int width)
 			*dataIt++ = corner;
 		}
 	}
-	// Adjust the tile indices so that tileIndex[i] is the start of tile i.
-	tileIndex.insert(tileIndex.begin(), 0);
-
+	// Adjust the band indices so that bandIndex[i] is the start of band i.
+	bandIndex.insert(bandIndex.begin(), 0);
+	
 	glBufferData(GL_ARRAY_BUFFER, sizeof(data.front()) * data.size(), data.data(), GL_STATIC_DRAW);
 	
 	// connect the xy to the "vert" attribute of the vertex shader
@@ -13,6 +13,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef STAR_FIELD_H_
 #define STAR_FIELD_H_
 
+#include "DrawList.h"
 #include "Shader.h"
 
 #include "gl_header.h"
@@ -46,10 +47,14 @@ private:
 	
 private:
 	int widthMod;
-	int tileCols;
-	std::vector<int> tileIndex;
+	// The stars are sorted into horizontal bands. This is the index of the
+	// first star in each band, plus the total number of stars.
+	std::vector<int> bandIndex;
 	
 	std::vector<Body> haze;
+	// The list the haze is drawn with is kept from one frame to the next, so
+	// its storage can be reused.
+	mutable DrawList hazeList;
 	
 	Shader shader;
 	GLuint vao;
@@ -63,6 +68,8 @@ private:
 	GLuint rotateI;
 	GLuint elongationI;
 	GLuint translateI;
+	GLuint originI;
+	GLuint widthI;
 	GLuint brightnessI;
 };
 
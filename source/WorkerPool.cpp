@@ -0,0 +1,111 @@
+/* WorkerPool.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "WorkerPool.h"
+
+using namespace std;
+
+
+
+// Constructor, which starts up the worker threads.
+WorkerPool::WorkerPool(unsigned workers)
+{
+	threads.resize(workers);
+	for(thread &t : threads)
+		t = thread(ref(*this));
+}
+
+
+
+// Destructor, which waits for all worker threads to wrap up.
+WorkerPool::~WorkerPool()
+{
+	{
+		lock_guard<mutex> lock(workMutex);
+		terminate = true;
+	}
+	workCondition.notify_all();
+	for(thread &t : threads)
+		t.join();
+}
+
+
+
+// Run task(i) for every i in [0, count). If useWorkers is false, all the
+// tasks are run on the calling thread, in order.
+void WorkerPool::Run(unsigned count, const function<void(unsigned)> &task, bool useWorkers)
+{
+	// Don't bother waking up the workers if there is only one task.
+	if(threads.empty() || !useWorkers || count < 2)
+	{
+		for(unsigned i = 0; i < count; ++i)
+			task(i);
+		return;
+	}
+	
+	unique_lock<mutex> lock(workMutex);
+	this->task = &task;
+	this->count = count;
+	next = 0;
+	done = 0;
+	workCondition.notify_all();
+	
+	// Work on the batch alongside the worker threads.
+	while(next < count)
+	{
+		unsigned i = next++;
+		lock.unlock();
+		task(i);
+		lock.lock();
+		++done;
+	}
+	// Wait for any tasks that are still being worked on in other threads.
+	while(done < count)
+		doneCondition.wait(lock);
+	
+	this->task = nullptr;
+	this->count = 0;
+	next = 0;
+}
+
+
+
+// Get the number of worker threads.
+unsigned WorkerPool::Workers() const
+{
+	return threads.size();
+}
+
+
+
+// Thread entry point.
+void WorkerPool::operator()()
+{
+	unique_lock<mutex> lock(workMutex);
+	while(true)
+	{
+		while(!terminate && next >= count)
+			workCondition.wait(lock);
+		if(terminate)
+			return;
+		
+		// Claim the next task in the batch, and run it without holding the lock.
+		unsigned i = next++;
+		const function<void(unsigned)> &current = *task;
+		lock.unlock();
+		current(i);
+		lock.lock();
+		
+		if(++done == count)
+			doneCondition.notify_all();
+	}
+}
@@ -0,0 +1,62 @@
+/* WorkerPool.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef WORKER_POOL_H_
+#define WORKER_POOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+
+// Class representing a set of worker threads that can split up a batch of
+// independent tasks. The thread that calls Run() also works on the batch, and
+// Run() does not return until every task in it is done. Tasks may be run in
+// any order and on any thread, so each one must only modify its own data.
+class WorkerPool {
+public:
+	// Create the given number of worker threads (in addition to the thread
+	// that will be calling Run()). With no workers, every task runs inline.
+	explicit WorkerPool(unsigned workers);
+	~WorkerPool();
+	
+	// Run task(i) for every i in [0, count). If useWorkers is false, all the
+	// tasks are run on the calling thread, in order.
+	void Run(unsigned count, const std::function<void(unsigned)> &task, bool useWorkers = true);
+	
+	// Get the number of worker threads.
+	unsigned Workers() const;
+	
+	// Thread entry point.
+	void operator()();
+	
+	
+private:
+	std::vector<std::thread> threads;
+	std::mutex workMutex;
+	std::condition_variable workCondition;
+	std::condition_variable doneCondition;
+	
+	// The batch of tasks currently being worked on.
+	const std::function<void(unsigned)> *task = nullptr;
+	unsigned count = 0;
+	unsigned next = 0;
+	unsigned done = 0;
+	bool terminate = false;
+};
+
+
+
+#endif
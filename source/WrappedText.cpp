@@ -157,8 +157,11 @@ int WrappedText::Height() const
 // Draw the text.
 void WrappedText::Draw(const Point &topLeft, const Color &color) const
 {
+	// Draw all the words with a single draw call.
+	Font::BeginBatch();
 	for(const Word &w : words)
 		font->Draw(text.c_str() + w.Index(), w.Pos() + topLeft, color);
+	Font::EndBatch();
 }
 
 
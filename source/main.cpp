@@ -121,7 +121,6 @@ int main(int argc, char *argv[])
 		if(SDL_GetCurrentDisplayMode(0, &mode))
 			return DoError("Unable to query monitor resolution!");
 		
-		Preferences::Load();
 		Uint32 flags = SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_SHOWN | SDL_WINDOW_ALLOW_HIGHDPI;
 		bool isFullscreen = Preferences::Has("fullscreen");
 		if(isFullscreen)
@@ -362,6 +361,10 @@ int main(int argc, char *argv[])
 			if(fastForward)
 				SpriteShader::Draw(SpriteSet::Get("ui/fast forward"), Screen::TopLeft() + Point(10., 10.));
 			
+			// Upload any sprites that have finished loading, and unload any that
+			// have not been drawn in a while if they are using too much memory.
+			GameData::StepSprites();
+			
 			SDL_GL_SwapWindow(window);
 			timer.Wait();
 		}